@@ -1,6 +1,9 @@
 option(WARNINGS_AS_ERRORS "Treat warnings as errors" OFF)
 option(USE_ASAN "Use Address Sanitizer" OFF)
 option(USE_MSAN "Use Memory Sanitizer" OFF)
+option(ENABLE_METRICS "Compile per-node game counters and timing histograms" ON)
+set(GENERATOR_ENTITATI "100000" CACHE STRING "Entities per tree for the genereaza_arbori target")
+set(BENCHMARK_ENTITATI "1000,10000,100000" CACHE STRING "Comma-separated tree sizes for the benchmark target")
 option(CMAKE_COLOR_DIAGNOSTICS "Enable color diagnostics" ON)
 
 # update name in .github/workflows/cmake.yml:27 when changing "bin" name here
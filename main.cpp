@@ -7,13 +7,74 @@
 #include <map>
 #include <algorithm>
 #include <utility>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
+#include <filesystem>
+#include <span>
+#include <cstring>
+#include <type_traits>
+#include <bit>
+#include <array>
+#include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <cstdlib>
+#include <cerrno>
+#include <cmath>
+#include <random>
+#include <charconv>
 #include "external/nlohmann/json.hpp"
 
+#if defined(__unix__) || defined(__APPLE__)
+#define AKINATOR_POSIX 1
+#include <arpa/inet.h>
+#include <csignal>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#else
+#define AKINATOR_POSIX 0
+#if defined(_WIN32)
+#include <process.h>
+#endif
+#endif
+
+// Id-ul procesului curent, pentru nume de fisiere temporare unice intre procese.
+inline long idProces() {
+#if AKINATOR_POSIX
+    return static_cast<long>(::getpid());
+#elif defined(_WIN32)
+    return static_cast<long>(::_getpid());
+#else
+    return 0;
+#endif
+}
+
+// Contoarele pe nod si histogramele de timp (sectiunea 2); CMake le opreste cu
+// -DENABLE_METRICS=OFF, caz in care toate punctele de masura devin functii goale.
+#ifndef AKINATOR_METRICI
+#define AKINATOR_METRICI 1
+#endif
+
 using json = nlohmann::json;
 
 // Declaratii forward
 class Entitate;
-class Nod;
+struct Nod;
 class ArboreAkinator;
 class JocAkinator;
 class ManagerRaspunsuri;
@@ -26,7 +87,7 @@ const std::string FISIER_IESIRE = "raspuns.txt";
 // -----------------------------------------------------------
 
 void primaBibliotecaExterna() {}
-void aDouaBibliotecaExterna(std::ostream& os, const std::string& data) {
+void aDouaBibliotecaExterna(std::ostream& os, std::string_view data) {
     (void)data;
     (void)os;
 }
@@ -35,347 +96,5130 @@ void aDouaBibliotecaExterna(std::ostream& os, const std::string& data) {
 // 2. STRUCTURI DATE
 // -----------------------------------------------------------
 
+// Entitatea ghicita este o vedere asupra pool-ului de siruri al arborelui
+// din care provine; ramane valida cat timp traieste arborele respectiv.
 class Entitate {
 public:
-    std::string nume;
-    std::string domeniu;
-    std::string tip;
+    std::string_view nume;
+    std::string_view domeniu;
+    std::string_view tip;
 
     Entitate() = default;
-    Entitate(std::string n, std::string d, std::string t) :
-        nume(std::move(n)), domeniu(std::move(d)), tip(std::move(t)) {}
-
-    virtual ~Entitate() = default;
-    Entitate(const Entitate& other) = default;
-    Entitate& operator=(const Entitate& other) = default;
+    Entitate(std::string_view n, std::string_view d, std::string_view t) :
+        nume(n), domeniu(d), tip(t) {}
 
     bool operator==(const Entitate& other) const {
         return nume == other.nume;
     }
 };
 
-class Nod {
-public:
-    Entitate* ghicitoare_ = nullptr;
+// Nodurile traiesc intr-o arena plata (std::vector<Nod>) si se refera unul la
+// altul prin indici pe 32 de biti; NOD_NUL tine locul vechiului nullptr.
+using IndexNod = std::uint32_t;
+inline constexpr IndexNod NOD_NUL = std::numeric_limits<IndexNod>::max();
+
+// Referinta la un sir din pool-ul arborelui.
+struct SirPool {
+    std::uint32_t offset = 0;
+    std::uint32_t lungime = 0;
+};
+
+struct Nod {
+    SirPool text;                       // intrebarea sau numele entitatii (frunza)
+    IndexNod da = NOD_NUL;
+    IndexNod nu = NOD_NUL;
+    std::uint32_t entitate = NOD_NUL;   // index in entitati_, doar pentru frunze
+
+    bool esteFrunza() const { return entitate != NOD_NUL; }
+};
+
+struct DateEntitate {
+    SirPool domeniu;
+    SirPool tip;
+};
+
+// Un pas pe drumul dintr-un arbore: intrebarea (nodul) si raspunsul dat la ea.
+struct PasDrum {
+    IndexNod nod;
+    bool da;
+};
+
+// O lectie invatata dupa o ghicire gresita: la frunza la care duce `cale` (cate un
+// 'd' sau 'n' pentru fiecare raspuns, pornind din radacina) jucatorul se gandea la
+// alta entitate, iar `intrebare` le deosebeste; `raspuns_da` e raspunsul pentru cea noua.
+struct Lectie {
+    std::string cale;
+    std::string nume;
+    std::string domeniu;
+    std::string tip;
     std::string intrebare;
-    Nod* da = nullptr;
-    Nod* nu = nullptr;
+    bool raspuns_da = true;
+};
 
-    // CORECTIE Cppcheck: Adăugăm explicit
-    explicit Nod(Entitate* e) : ghicitoare_(e) {}
-    explicit Nod(std::string q) : intrebare(std::move(q)) {}
+// Forma din jurnal: un obiect JSON pe linie.
+inline std::string lectieCaJSON(const Lectie& l) {
+    const json j = {
+        {"cale", l.cale},
+        {"entitate", {{"nume", l.nume}, {"domeniu", l.domeniu}, {"tip", l.tip}}},
+        {"intrebare", l.intrebare},
+        {"raspuns", l.raspuns_da ? "da" : "nu"}
+    };
+    return j.dump();
+}
 
-    // R3: DESTRUCTOR
-    ~Nod() {
-        delete ghicitoare_;
+inline Lectie lectieDinJSON(std::string_view linie) {
+    try {
+        const json j = json::parse(linie);
+        const json& e = j.at("entitate");
+        return {
+            j.at("cale").get<std::string>(),
+            e.at("nume").get<std::string>(),
+            e.at("domeniu").get<std::string>(),
+            e.at("tip").get<std::string>(),
+            j.at("intrebare").get<std::string>(),
+            j.at("raspuns").get<std::string>() == "da"
+        };
+    } catch (const json::exception& e) {
+        throw std::runtime_error(std::string("Lectie invalida: ") + e.what());
     }
+}
 
-    // R3: CONSTRUCTOR DE COPIERE (Deep Copy Entitate)
-    Nod(const Nod& other) :
-        intrebare(other.intrebare), da(nullptr), nu(nullptr)
-    {
-        if (other.ghicitoare_) {
-            ghicitoare_ = new Entitate(*other.ghicitoare_);
+// Scrie s ca sir JSON intre ghilimele. Textele sunt UTF-8 valid (vin dintr-un JSON
+// parsat), deci ajunge sa fie escapate ghilimelele, backslash-ul si caracterele de control.
+inline void scrieSirJSON(std::ostream& os, std::string_view s) {
+    os << '"';
+    std::size_t inceput = 0;
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        const auto c = static_cast<unsigned char>(s[i]);
+        if (c != '"' && c != '\\' && c >= 0x20) continue;
+        os.write(s.data() + inceput, static_cast<std::streamsize>(i - inceput));
+        inceput = i + 1;
+        if (c == '"' || c == '\\') {
+            os << '\\' << static_cast<char>(c);
         } else {
-            ghicitoare_ = nullptr;
+            constexpr char hex[] = "0123456789abcdef";
+            os << "\\u00" << hex[c >> 4] << hex[c & 0xF];
         }
     }
+    os.write(s.data() + inceput, static_cast<std::streamsize>(s.size() - inceput));
+    os << '"';
+}
 
-    // R3: OPERATOR DE ATRIBUIRE (Copy and Swap Idiom)
-    Nod& operator=(Nod other) {
-        std::swap(ghicitoare_, other.ghicitoare_);
-        std::swap(intrebare, other.intrebare);
-        std::swap(da, other.da);
-        std::swap(nu, other.nu);
-        return *this;
+// Forma de cautare a unui nume (UTF-8): litere mici, fara diacritice (ă/â -> a,
+// ș/ş -> s, ț/ţ -> t, é -> e, ß -> ss...), spatiile adunate intr-unul singur si taiate
+// la capete. Se pliaza Latin-1 si Latin Extended-A, plus ș/ț cu virgula si semnele
+// combinante; restul caracterelor (si octetii invalizi) raman neschimbate.
+// Rezultatul se adauga la sfarsitul lui `rezultat`.
+inline void normalizeazaNume(std::string_view s, std::string& rezultat) {
+    // U+00C0..U+017F: litera de baza; '.' = neschimbat, cifrele = ligaturi.
+    static constexpr std::string_view PLIERE =
+        "aaaaaa1ceeeeiiiidnooooo.ouuuuy23aaaaaa1ceeeeiiiidnooooo.ouuuuy2y"
+        "aaaaaaccccccccddddeeeeeeeeeegggggggghhhhiiiiiiiiii44jjkkklllllll"
+        "lllnnnnnnnnnoooooo55rrrrrrssssssssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+    static constexpr std::array<std::string_view, 5> LIGATURI = {"ae", "th", "ss", "ij", "oe"};
+
+    // Iesirea nu e niciodata mai lunga decat intrarea, deci se scrie direct in buffer.
+    const std::size_t inceput = rezultat.size();
+    rezultat.resize(inceput + s.size());
+    char* const start = rezultat.data() + inceput;
+    char* p = start;
+    bool spatiu = false;
+    auto adauga = [&](std::string_view text) {
+        if (spatiu && p != start) *p++ = ' ';
+        spatiu = false;
+        p = std::copy(text.begin(), text.end(), p);
+    };
+
+    for (std::size_t i = 0; i < s.size();) {
+        const auto c = static_cast<unsigned char>(s[i]);
+        if (c < 0x80) {
+            if (c == ' ' || (c >= '\t' && c <= '\r')) {
+                spatiu = true;
+            } else {
+                if (spatiu && p != start) *p++ = ' ';
+                spatiu = false;
+                *p++ = static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+            }
+            ++i;
+            continue;
+        }
+        if ((c & 0xE0) == 0xC0 && i + 1 < s.size() && (static_cast<unsigned char>(s[i + 1]) & 0xC0) == 0x80) {
+            const std::uint32_t cod = ((c & 0x1FU) << 6) | (static_cast<unsigned char>(s[i + 1]) & 0x3FU);
+            char baza = '.';
+            if (cod >= 0xC0 && cod < 0x180) baza = PLIERE[cod - 0xC0];
+            else if (cod == 0x218 || cod == 0x219) baza = 's';
+            else if (cod == 0x21A || cod == 0x21B) baza = 't';
+
+            if (cod == 0xA0) {
+                spatiu = true;
+            } else if (cod >= 0x300 && cod < 0x370) {
+                // semn diacritic combinant (forma descompusa): se sare
+            } else if (baza >= '1' && baza <= '5') {
+                adauga(LIGATURI[static_cast<std::size_t>(baza - '1')]);
+            } else if (baza != '.') {
+                adauga(std::string_view(&baza, 1));
+            } else {
+                adauga(s.substr(i, 2));
+            }
+            i += 2;
+            continue;
+        }
+        adauga(s.substr(i, 1));
+        ++i;
     }
+    rezultat.resize(inceput + static_cast<std::size_t>(p - start));
+}
 
-    // Deplasare
-    Nod(Nod&& other) noexcept = default;
-    Nod& operator=(Nod&& other) noexcept = default;
+inline std::string normalizeazaNume(std::string_view s) {
+    std::string rezultat;
+    rezultat.reserve(s.size());
+    normalizeazaNume(s, rezultat);
+    return rezultat;
+}
+
+// Formatul binar (*.akb) este imaginea arenei pe disc, citita in loc dupa mmap:
+// antet | Nod[numar_noduri] | DateEntitate[numar_entitati] | pool.
+// Toate campurile sunt little-endian; suma de control acopera tot ce urmeaza antetului.
+struct AntetBinar {
+    char magic[4];
+    std::uint32_t versiune;
+    std::uint32_t radacina;
+    std::uint32_t numar_noduri;
+    std::uint32_t numar_entitati;
+    std::uint32_t lungime_pool;
+    std::uint64_t suma_control;
 };
 
-// -----------------------------------------------------------
-// 3. ARBORE AKINATOR (MODEL)
-// -----------------------------------------------------------
+inline constexpr char MAGIC_BINAR[4] = {'A', 'K', 'B', '\0'};
+inline constexpr std::uint32_t VERSIUNE_BINAR = 1;
 
-class ArboreAkinator {
+static_assert(std::is_trivially_copyable_v<Nod> && sizeof(Nod) == 20);
+static_assert(std::is_trivially_copyable_v<DateEntitate> && sizeof(DateEntitate) == 16);
+static_assert(sizeof(AntetBinar) == 32 && alignof(Nod) <= 8);
+
+// FNV-1a pe cuvinte de 8 octeti: destul de rapid ca sa nu conteze la incarcare.
+inline std::uint64_t sumaControl(const std::byte* date, std::size_t n) {
+    std::uint64_t h = 14695981039346656037ULL;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t cuvant;
+        std::memcpy(&cuvant, date + i, 8);
+        h = (h ^ cuvant) * 1099511628211ULL;
+    }
+    for (; i < n; ++i) {
+        h = (h ^ static_cast<std::uint8_t>(date[i])) * 1099511628211ULL;
+    }
+    return h;
+}
+
+// Fisier proiectat in memorie doar pentru citire. Pe platformele fara mmap
+// continutul se citeste intr-un buffer, cu aceeasi interfata.
+class FisierMapat {
 private:
-    Nod* radacina_ = nullptr;
-    std::string tema_;
+    const std::byte* date_ = nullptr;
+    std::size_t lungime_ = 0;
+#if AKINATOR_POSIX
+    void* mapare_ = nullptr;
+#else
+    std::vector<std::byte> buffer_;
+#endif
 
-    void elibereazaMemorie(Nod* nod) {
-        if (nod == nullptr) return;
-        elibereazaMemorie(nod->da);
-        elibereazaMemorie(nod->nu);
-        delete nod;
+public:
+    explicit FisierMapat(const std::string& cale) {
+#if AKINATOR_POSIX
+        const int fd = ::open(cale.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Nu se poate deschide " + cale);
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Nu se poate citi dimensiunea lui " + cale);
+        }
+        lungime_ = static_cast<std::size_t>(st.st_size);
+        if (lungime_ != 0) {
+            mapare_ = ::mmap(nullptr, lungime_, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (mapare_ == MAP_FAILED) {
+            mapare_ = nullptr;
+            throw std::runtime_error("mmap a esuat pentru " + cale);
+        }
+        date_ = static_cast<const std::byte*>(mapare_);
+#else
+        std::ifstream f(cale, std::ios::binary);
+        if (!f.is_open()) {
+            throw std::runtime_error("Nu se poate deschide " + cale);
+        }
+        f.seekg(0, std::ios::end);
+        buffer_.resize(static_cast<std::size_t>(f.tellg()));
+        f.seekg(0);
+        f.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+        date_ = buffer_.data();
+        lungime_ = buffer_.size();
+#endif
     }
 
-    Nod* cloneNodRecursiv(const Nod* nod_sursa) const {
-        if (nod_sursa == nullptr) return nullptr;
-        Nod* nod_nou = new Nod(*nod_sursa);
-        nod_nou->da = cloneNodRecursiv(nod_sursa->da);
-        nod_nou->nu = cloneNodRecursiv(nod_sursa->nu);
-        return nod_nou;
+    ~FisierMapat() {
+#if AKINATOR_POSIX
+        if (mapare_ != nullptr) ::munmap(mapare_, lungime_);
+#endif
     }
 
-    Nod* parsezNodJSON(const json& j) {
-        if (j.is_null()) return nullptr;
+    FisierMapat(const FisierMapat&) = delete;
+    FisierMapat& operator=(const FisierMapat&) = delete;
+
+    const std::byte* date() const { return date_; }
+    std::size_t lungime() const { return lungime_; }
+};
 
-        if (j.contains("entitate")) {
-            const auto& entitate_json = j.at("entitate");
-            Entitate* e = new Entitate(
-                entitate_json.at("nume").get<std::string>(),
-                entitate_json.at("domeniu").get<std::string>(),
-                entitate_json.at("tip").get<std::string>()
-            );
-            return new Nod(e);
-        } else if (j.contains("intrebare")) {
-            Nod* n = new Nod(j.at("intrebare").get<std::string>());
+// Jurnalul unei teme, blocat pentru scriere cat traieste obiectul. Il scriu mai multe
+// procese (serverul, `oop --invata`), deci pe POSIX adaugarile si compactarea se
+// serializeaza cu flock. Compactarea inlocuieste fisierul, asa ca dupa blocare se
+// verifica sa fie tot cel de la cale. Pe celelalte platforme ramane doar serializarea
+// din proces.
+class JurnalBlocat {
+private:
+    std::string cale_;
+#if AKINATOR_POSIX
+    int fd_ = -1;
+#else
+    std::ofstream f_;
+#endif
 
-            if (j.contains("da")) {
-                n->da = parsezNodJSON(j.at("da"));
+public:
+    explicit JurnalBlocat(std::string cale) : cale_(std::move(cale)) {
+#if AKINATOR_POSIX
+        for (;;) {
+            fd_ = ::open(cale_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            if (fd_ < 0) {
+                throw std::runtime_error("Nu se poate deschide jurnalul " + cale_);
             }
-            if (j.contains("nu")) {
-                n->nu = parsezNodJSON(j.at("nu"));
+            int blocat = ::flock(fd_, LOCK_EX);
+            while (blocat != 0 && errno == EINTR) blocat = ::flock(fd_, LOCK_EX);
+            if (blocat != 0) {
+                ::close(fd_);
+                throw std::runtime_error("Nu se poate bloca jurnalul " + cale_);
             }
-            return n;
+            struct stat deschis {};
+            struct stat curent {};
+            if (::fstat(fd_, &deschis) == 0 && ::stat(cale_.c_str(), &curent) == 0
+                && deschis.st_dev == curent.st_dev && deschis.st_ino == curent.st_ino) {
+                return;
+            }
+            ::close(fd_);  // compactat intre open si flock: reluam cu fisierul nou
+        }
+#else
+        f_.open(cale_, std::ios::binary | std::ios::app);
+        if (!f_.is_open()) {
+            throw std::runtime_error("Nu se poate deschide jurnalul " + cale_);
         }
-        return nullptr;
+#endif
     }
 
-public:
-    // CORECTIE Cppcheck: Adăugăm explicit
-    explicit ArboreAkinator(std::string tema) : tema_(std::move(tema)) {}
-    ArboreAkinator() : tema_("Necunoscuta") {}
-
-    // R3: DESTRUCTOR
-    ~ArboreAkinator() { elibereazaMemorie(radacina_); radacina_ = nullptr; }
+    ~JurnalBlocat() {
+#if AKINATOR_POSIX
+        ::close(fd_);  // elibereaza si blocarea
+#endif
+    }
 
-    // R3: CONSTRUCTOR DE COPIERE (ORDINE CORECTATĂ)
-    ArboreAkinator(const ArboreAkinator& other) :
-        radacina_(cloneNodRecursiv(other.radacina_)),
-        tema_(other.tema_)
-    {}
+    JurnalBlocat(const JurnalBlocat&) = delete;
+    JurnalBlocat& operator=(const JurnalBlocat&) = delete;
 
-    // R3: OPERATOR DE ATRIBUIRE
-    ArboreAkinator& operator=(ArboreAkinator other) {
-        std::swap(radacina_, other.radacina_);
-        std::swap(tema_, other.tema_);
-        return *this;
+    void adauga(std::string_view linie) {
+#if AKINATOR_POSIX
+        while (!linie.empty()) {
+            const ssize_t n = ::write(fd_, linie.data(), linie.size());
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                throw std::runtime_error("Nu se poate scrie jurnalul " + cale_);
+            }
+            linie.remove_prefix(static_cast<std::size_t>(n));
+        }
+#else
+        f_.write(linie.data(), static_cast<std::streamsize>(linie.size()));
+        f_.flush();
+        if (!f_) {
+            throw std::runtime_error("Nu se poate scrie jurnalul " + cale_);
+        }
+#endif
     }
 
-    // Deplasare
-    ArboreAkinator(ArboreAkinator&& other) noexcept = default;
-    ArboreAkinator& operator=(ArboreAkinator&& other) noexcept = default;
-
+    // Lungimea curenta; cat timp obiectul traieste, nimeni altcineva nu o schimba.
+    std::uintmax_t lungime() const {
+#if AKINATOR_POSIX
+        struct stat st {};
+        return ::fstat(fd_, &st) == 0 ? static_cast<std::uintmax_t>(st.st_size) : 0;
+#else
+        std::error_code ec;
+        const std::uintmax_t n = std::filesystem::file_size(cale_, ec);
+        return ec ? 0 : n;
+#endif
+    }
 
-    void incarcaDinFisier(const std::string& nume_fisier) {
-        std::ifstream f(nume_fisier);
-        if (!f.is_open()) {
-             return;
+    // Pastreaza doar octetii de la `de_la` incolo. Coada se copiaza intr-un fisier nou,
+    // redenumit peste jurnal; daca nu ramane nimic, jurnalul se sterge.
+    void pastreazaDeLa(std::uintmax_t de_la) {
+#if !AKINATOR_POSIX
+        f_.close();
+#endif
+        std::ifstream vechi(cale_, std::ios::binary);
+        if (!vechi.is_open()) {
+            throw std::runtime_error("Nu se poate citi jurnalul " + cale_);
         }
-
-        try {
-            json data = json::parse(f);
-            if (data.contains("radacina")) {
-                if (radacina_) { elibereazaMemorie(radacina_); }
-                radacina_ = parsezNodJSON(data.at("radacina"));
+        vechi.seekg(static_cast<std::streamoff>(de_la));
+        const std::string coada{std::istreambuf_iterator<char>(vechi), std::istreambuf_iterator<char>()};
+        if (coada.empty()) {
+            std::filesystem::remove(cale_);
+            return;
+        }
+        const std::string temporar = cale_ + ".tmp";
+        {
+            std::ofstream nou(temporar, std::ios::binary | std::ios::trunc);
+            nou.write(coada.data(), static_cast<std::streamsize>(coada.size()));
+            if (!nou) {
+                throw std::runtime_error("Scriere incompleta in " + temporar);
             }
-        } catch (json::parse_error& e) {
-             throw std::runtime_error("Eroare la parsarea JSON din " + nume_fisier + ": " + e.what());
         }
+        std::filesystem::rename(temporar, cale_);
     }
+};
 
-    // Functia de ghicire
-    const Entitate* determinaEntitatea(std::istream& is, std::ostream& os) const {
-        Nod* curent = radacina_;
-        std::string raspuns;
+// Destinatiile textului unui joc: orice tip cu append(std::string_view), ca std::string
+// (serverul, loturile paralele), IesireFlux peste un std::ostream, IesireStdout sau
+// IesireNula, pentru care transcrierea nici nu se mai formateaza.
+template <typename Iesire>
+concept IesireText = requires(Iesire& iesire, std::string_view text) { iesire.append(text); };
 
-        while (curent != nullptr && curent->ghicitoare_ == nullptr) {
-            os << "Intrebare: " << curent->intrebare << " (da/nu)?" << std::endl;
-            aDouaBibliotecaExterna(os, curent->intrebare);
+class IesireFlux {
+private:
+    std::ostream& os_;
 
-            if (!(is >> raspuns)) {
-                os << "Eroare la citirea raspunsului din fisier." << std::endl;
-                return nullptr;
-            }
+public:
+    explicit IesireFlux(std::ostream& os) : os_(os) {}
+    IesireFlux& append(std::string_view text) {
+        os_.write(text.data(), static_cast<std::streamsize>(text.size()));
+        return *this;
+    }
+};
 
-            if (raspuns == "da") {
-                curent = curent->da;
-            } else if (raspuns == "nu") {
-                curent = curent->nu;
-            } else {
-                os << "Raspuns invalid. Incearca 'da' sau 'nu'." << std::endl;
-            }
+struct IesireNula {
+    IesireNula& append(std::string_view) { return *this; }
+};
+
+// Iesirea standard ocolind std::cout: un buffer prealocat, scris cu un singur apel cand
+// se umple. Un text mai mare decat locul ramas pleaca impreuna cu bufferul intr-un
+// singur writev, fara sa mai fie copiat. Fara POSIX se scrie prin std::cout, tot pe bucati.
+class IesireStdout {
+private:
+    static constexpr std::size_t CAPACITATE = 64 * 1024;
+    std::unique_ptr<char[]> buffer_ = std::make_unique_for_overwrite<char[]>(CAPACITATE);
+    std::size_t folosit_ = 0;
+
+    static void scrie(std::string_view a, std::string_view b) {
+#if AKINATOR_POSIX
+        while (!a.empty() || !b.empty()) {
+            iovec bucati[2] = {{const_cast<char*>(a.data()), a.size()}, {const_cast<char*>(b.data()), b.size()}};
+            const ssize_t n = ::writev(STDOUT_FILENO, bucati, 2);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return;  // iesirea s-a inchis; restul nu mai are unde ajunge
+            const auto scris = static_cast<std::size_t>(n);
+            const std::size_t din_a = std::min(scris, a.size());
+            a.remove_prefix(din_a);
+            b.remove_prefix(scris - din_a);
         }
+#else
+        std::cout.write(a.data(), static_cast<std::streamsize>(a.size()));
+        std::cout.write(b.data(), static_cast<std::streamsize>(b.size()));
+#endif
+    }
 
-        if (curent != nullptr && curent->ghicitoare_ != nullptr) {
-            os << "M-am gandit la: " << curent->ghicitoare_->nume << ". E corect (da/nu)?" << std::endl;
-            if (!(is >> raspuns)) {
-                os << "Eroare la citirea raspunsului final din fisier." << std::endl;
-                return nullptr;
-            }
+public:
+    IesireStdout() { std::cout.flush(); }  // ce era deja in std::cout iese primul
+    ~IesireStdout() { goleste(); }
 
-            if (raspuns == "da") {
-                return curent->ghicitoare_;
-            }
+    IesireStdout(const IesireStdout&) = delete;
+    IesireStdout& operator=(const IesireStdout&) = delete;
+
+    IesireStdout& append(std::string_view text) {
+        if (text.size() <= CAPACITATE - folosit_) {
+            std::memcpy(buffer_.get() + folosit_, text.data(), text.size());
+            folosit_ += text.size();
+        } else {
+            scrie({buffer_.get(), folosit_}, text);
+            folosit_ = 0;
         }
-        return nullptr;
+        return *this;
     }
 
-    int calculeazaAdancime(Nod* nod) const {
-        if (nod == nullptr) return 0;
-        return 1 + std::max(calculeazaAdancime(nod->da), calculeazaAdancime(nod->nu));
+    void goleste() {
+        scrie({buffer_.get(), folosit_}, {});
+        folosit_ = 0;
     }
-    int calculeazaAdancime() const { return calculeazaAdancime(radacina_); }
-    const std::string& getTema() const { return tema_; }
+};
 
-    friend std::ostream& operator<<(std::ostream& os, const ArboreAkinator& arbore) {
-        if (arbore.radacina_ != nullptr) {
-            os << "Arbore curent (Adancime): " << arbore.calculeazaAdancime();
-        } else {
-            os << "Arbore curent: [Gol]";
+// Flux de citire peste un text care exista deja (o linie, un lot de sesiuni), fara sa
+// fie copiat; seteaza() il muta pe alt text si sterge starea de eroare.
+class FluxText : public std::istream {
+private:
+    struct Buffer : std::streambuf {
+        void seteaza(std::string_view text) {
+            char* inceput = const_cast<char*>(text.data());  // doar citit
+            setg(inceput, inceput, inceput + text.size());
         }
-        return os;
+    };
+    Buffer buffer_;
+
+public:
+    FluxText() : std::istream(nullptr) { rdbuf(&buffer_); }
+    explicit FluxText(std::string_view text) : FluxText() { seteaza(text); }
+
+    FluxText(const FluxText&) = delete;
+    FluxText& operator=(const FluxText&) = delete;
+
+    void seteaza(std::string_view text) {
+        buffer_.seteaza(text);
+        clear();
     }
 };
 
-// -----------------------------------------------------------
-// 4. MANAGER RASPUNSURI (REPOZITORIU)
-// -----------------------------------------------------------
+template <IesireText Iesire>
+void adaugaNumar(Iesire& iesire, std::uint64_t numar) {
+    char cifre[20];
+    const auto rezultat = std::to_chars(std::begin(cifre), std::end(cifre), numar);
+    iesire.append(std::string_view(cifre, static_cast<std::size_t>(rezultat.ptr - cifre)));
+}
 
-class ManagerRaspunsuri {
+// Vederi validate asupra unui fisier .akb; tin maparea in viata.
+struct ImagineBinara {
+    std::shared_ptr<const FisierMapat> fisier;
+    std::span<const Nod> noduri;
+    std::span<const DateEntitate> entitati;
+    std::string_view pool;
+};
+
+// Histograma log-liniara de durate (ns): 4 sub-intervale pe fiecare putere a lui 2,
+// deci percentilele au eroare relativa de cel mult ~19%, in memorie constanta.
+class HistogramaTimp {
 private:
-    std::map<std::string, ArboreAkinator> teme_; // Membru privat
-    ArboreAkinator* arbore_curent_ = nullptr;
+    static constexpr int SUB_INTERVALE = 4;
+    std::array<std::uint64_t, 64 * SUB_INTERVALE> contoare_{};
+    std::uint64_t total_ = 0;
+    std::uint64_t suma_ns_ = 0;
+    std::uint64_t maxim_ns_ = 0;
+
+    static std::size_t interval(std::uint64_t ns) {
+        if (ns < SUB_INTERVALE) return static_cast<std::size_t>(ns);
+        const int exponent = std::bit_width(ns) - 1;
+        const auto sub = static_cast<std::size_t>((ns >> (exponent - 2)) & (SUB_INTERVALE - 1));
+        return static_cast<std::size_t>(exponent - 1) * SUB_INTERVALE + sub;
+    }
+
+    // Limita superioara a intervalului, folosita ca valoare raportata.
+    static std::uint64_t limita(std::size_t i) {
+        if (i < SUB_INTERVALE) return i;
+        const std::size_t exponent = i / SUB_INTERVALE + 1;
+        const std::uint64_t sub = i % SUB_INTERVALE;
+        return ((SUB_INTERVALE + sub + 1) << (exponent - 2)) - 1;
+    }
 
 public:
-    ManagerRaspunsuri() {
-        teme_.emplace("animale", ArboreAkinator("animale"));
-        teme_.emplace("tari", ArboreAkinator("tari"));
-        teme_.emplace("vedete", ArboreAkinator("vedete"));
+    void adauga(std::uint64_t ns) {
+        ++contoare_[interval(ns)];
+        ++total_;
+        suma_ns_ += ns;
+        maxim_ns_ = std::max(maxim_ns_, ns);
+    }
 
-        for (auto& pair : teme_) {
-            try {
-                pair.second.incarcaDinFisier(pair.first + "_arbore.json");
-            } catch (const std::runtime_error& e) {
-                 std::cerr << "Atentie: " << e.what() << std::endl;
-            }
+    void combina(const HistogramaTimp& other) {
+        for (std::size_t i = 0; i < contoare_.size(); ++i) contoare_[i] += other.contoare_[i];
+        total_ += other.total_;
+        suma_ns_ += other.suma_ns_;
+        maxim_ns_ = std::max(maxim_ns_, other.maxim_ns_);
+    }
+
+    std::uint64_t percentila(double p) const {
+        if (total_ == 0) return 0;
+        const auto prag = static_cast<std::uint64_t>(p * static_cast<double>(total_ - 1)) + 1;
+        std::uint64_t cumulat = 0;
+        for (std::size_t i = 0; i < contoare_.size(); ++i) {
+            cumulat += contoare_[i];
+            if (cumulat >= prag) return std::min(limita(i), maxim_ns_);
         }
+        return maxim_ns_;
     }
 
-    // R3: DESTRUCTOR
-    ~ManagerRaspunsuri() {
-        delete arbore_curent_;
+    std::uint64_t total() const { return total_; }
+    std::uint64_t sumaNs() const { return suma_ns_; }
+    std::uint64_t maximNs() const { return maxim_ns_; }
+    double medieNs() const { return total_ ? static_cast<double>(suma_ns_) / static_cast<double>(total_) : 0.0; }
+};
+
+// Instrumentarea jocurilor. Fiecare fir isi tine contoarele proprii (fara atomice
+// RMW si fara lock pe drumul fierbinte: un singur scriitor, stocari relaxate), iar
+// colecteaza() le aduna la cerere. Contoarele unui arbore se tin dupa generatia lui:
+// lectiile doar adauga noduri, deci pastreaza generatia si indicii; o reincarcare de
+// pe disc primeste generatie noua.
+enum class FazaTimp : std::uint8_t { Incarcare, Selectare, Parcurgere, Iesire };
+inline constexpr std::size_t NUMAR_FAZE = 4;
+inline constexpr std::array<const char*, NUMAR_FAZE> NUME_FAZE = {"incarcare", "selectare", "parcurgere", "iesire"};
+
+struct ContorNod {
+    std::uint64_t vizite = 0;
+    std::uint64_t da = 0;
+    std::uint64_t nu = 0;
+    std::uint64_t invalide = 0;          // raspunsuri care nu sunt nici "da", nici "nu"
+    std::uint64_t ghiciri_gresite = 0;   // doar pentru frunze
+};
+
+struct InstantaneuMetrici {
+    std::map<std::uint64_t, std::vector<ContorNod>> arbori;  // pe generatie
+    std::array<HistogramaTimp, NUMAR_FAZE> timpi{};
+};
+
+#if AKINATOR_METRICI
+class Metrici {
+private:
+    // Contoarele unui arbore pe un fir: CAMPURI sloturi consecutive pe nod, in ordinea
+    // din ContorNod.
+    static constexpr std::size_t CAMPURI = 5;
+    enum Camp : std::size_t { Vizite, Da, Nu, Invalide, GhiciriGresite };
+
+    struct ContoareArbore {
+        std::unique_ptr<std::atomic<std::uint64_t>[]> valori;
+        std::size_t noduri = 0;
+    };
+
+    struct ContoareFir {
+        std::mutex mutex;  // proprietarul il ia doar cand schimba structura, colectorul mereu
+        std::map<std::uint64_t, ContoareArbore> arbori;
+        std::array<HistogramaTimp, NUMAR_FAZE> timpi{};  // protejat de mutex
+        std::uint64_t generatie_curenta = 0;             // folosite doar de proprietar
+        ContoareArbore* curent = nullptr;
+    };
+
+    struct Registru {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ContoareFir>> fire;  // raman si dupa ce firul se termina
+    };
+
+    // Nu se distruge niciodata: arborii care mai traiesc la iesire tot il folosesc.
+    static Registru& registru() {
+        static Registru& r = *new Registru;
+        return r;
     }
 
-    // R3: CONSTRUCTOR DE COPIERE
-    ManagerRaspunsuri(const ManagerRaspunsuri& other) : teme_(other.teme_) {
-        primaBibliotecaExterna();
+    static ContoareFir& firCurent() {
+        thread_local const std::shared_ptr<ContoareFir> fir = [] {
+            auto nou = std::make_shared<ContoareFir>();
+            std::lock_guard<std::mutex> lock(registru().mutex);
+            registru().fire.push_back(nou);
+            return nou;
+        }();
+        return *fir;
+    }
 
-        if (other.arbore_curent_) {
-            arbore_curent_ = new ArboreAkinator(*other.arbore_curent_);
-        } else {
-            arbore_curent_ = nullptr;
+    // Apelat cu mutex-ul firului luat; noile sloturi pornesc de la zero.
+    static void creste(ContoareArbore& a, std::size_t noduri) {
+        auto valori = std::make_unique<std::atomic<std::uint64_t>[]>(noduri * CAMPURI);
+        for (std::size_t i = 0; i < a.noduri * CAMPURI; ++i) {
+            valori[i].store(a.valori[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
         }
+        a.valori = std::move(valori);
+        a.noduri = noduri;
     }
 
-    // R3: OPERATOR DE ATRIBUIRE
-    ManagerRaspunsuri& operator=(ManagerRaspunsuri other) {
-        std::swap(teme_, other.teme_);
-        std::swap(arbore_curent_, other.arbore_curent_);
-        return *this;
+    // Sloturile nodului. Un arbore fara generatie (niciodata incarcat) nu se numara.
+    static std::atomic<std::uint64_t>* contor(std::uint64_t generatie, IndexNod nod, std::size_t numar_noduri) {
+        if (generatie == 0) {
+            thread_local std::array<std::atomic<std::uint64_t>, CAMPURI> ignorat{};
+            return ignorat.data();
+        }
+        ContoareFir& f = firCurent();
+        // curent poate ramane agatat de o generatie eliberata, dar aceea nu mai apare.
+        if (f.curent == nullptr || f.generatie_curenta != generatie || nod >= f.curent->noduri) {
+            std::lock_guard<std::mutex> lock(f.mutex);
+            ContoareArbore& a = f.arbori[generatie];
+            if (nod >= a.noduri) creste(a, std::max<std::size_t>(numar_noduri, nod + 1));
+            f.curent = &a;
+            f.generatie_curenta = generatie;
+        }
+        return &f.curent->valori[nod * CAMPURI];
     }
 
-    // Deplasare
-    ManagerRaspunsuri(ManagerRaspunsuri&& other) noexcept = default;
-    ManagerRaspunsuri& operator=(ManagerRaspunsuri&& other) noexcept = default;
+    static void incrementeaza(std::atomic<std::uint64_t>& c) {
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
 
-    void selecteazaTema(const std::string& tema) {
-        if (teme_.count(tema)) {
-            delete arbore_curent_;
-            arbore_curent_ = new ArboreAkinator(teme_.at(tema));
-            arbore_curent_->incarcaDinFisier(tema + "_arbore.json");
-        } else {
-            throw std::runtime_error("Tema nu exista.");
-        }
+public:
+    using Moment = std::chrono::steady_clock::time_point;
+
+    // Ceasul costa cat o parcurgere intreaga, asa ca timpii jocurilor se masoara doar pe
+    // un joc din ESANTION_TIMP (pe fir); contoarele pe nod raman exacte.
+    static constexpr std::uint32_t ESANTION_TIMP = 16;
+    static bool esantion(FazaTimp faza) {
+        thread_local std::array<std::uint32_t, NUMAR_FAZE> numar{};
+        return ++numar[static_cast<std::size_t>(faza)] % ESANTION_TIMP == 0;
     }
 
-    const ArboreAkinator* getArboreCurent() const { return arbore_curent_; }
+    static Moment acum() { return std::chrono::steady_clock::now(); }
+    static std::uint64_t nsDeLa(Moment start) {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(acum() - start).count());
+    }
 
-    friend std::ostream& operator<<(std::ostream& os, const ManagerRaspunsuri& manager) {
-        os << "ManagerRaspunsuri{ teme=[";
-        bool first = true;
-        for (const auto& pair : manager.teme_) {
-            if (!first) os << ", ";
-            os << pair.first << "(" << pair.second.calculeazaAdancime() << " noduri)";
-            first = false;
+    static void vizita(std::uint64_t generatie, IndexNod nod, std::size_t numar_noduri) {
+        incrementeaza(contor(generatie, nod, numar_noduri)[Vizite]);
+    }
+    static void raspuns(std::uint64_t generatie, IndexNod nod, std::size_t numar_noduri, bool da) {
+        incrementeaza(contor(generatie, nod, numar_noduri)[da ? Da : Nu]);
+    }
+    static void raspunsInvalid(std::uint64_t generatie, IndexNod nod, std::size_t numar_noduri) {
+        incrementeaza(contor(generatie, nod, numar_noduri)[Invalide]);
+    }
+    static void ghicireGresita(std::uint64_t generatie, IndexNod nod, std::size_t numar_noduri) {
+        incrementeaza(contor(generatie, nod, numar_noduri)[GhiciriGresite]);
+    }
+
+    static void timp(FazaTimp faza, std::uint64_t ns) {
+        ContoareFir& f = firCurent();
+        std::lock_guard<std::mutex> lock(f.mutex);
+        f.timpi[static_cast<std::size_t>(faza)].adauga(ns);
+    }
+
+    // Apelat cand dispare ultima copie a unui arbore din generatia data: niciun fir nu
+    // mai poate numara pentru ea, deci contoarele ei se sterg de peste tot.
+    static void elibereaza(std::uint64_t generatie) {
+        std::lock_guard<std::mutex> lock_registru(registru().mutex);
+        for (const auto& fir : registru().fire) {
+            std::lock_guard<std::mutex> lock(fir->mutex);
+            fir->arbori.erase(generatie);
         }
-        os << "] }";
-        return os;
+    }
+
+    // Suma peste toate firele, inclusiv cele terminate.
+    static InstantaneuMetrici colecteaza() {
+        InstantaneuMetrici rezultat;
+        std::lock_guard<std::mutex> lock_registru(registru().mutex);
+        for (const auto& fir : registru().fire) {
+            std::lock_guard<std::mutex> lock(fir->mutex);
+            for (const auto& [generatie, contoare] : fir->arbori) {
+                auto& suma = rezultat.arbori[generatie];
+                if (suma.size() < contoare.noduri) suma.resize(contoare.noduri);
+                for (std::size_t i = 0; i < contoare.noduri; ++i) {
+                    const std::atomic<std::uint64_t>* c = &contoare.valori[i * CAMPURI];
+                    suma[i].vizite += c[Vizite].load(std::memory_order_relaxed);
+                    suma[i].da += c[Da].load(std::memory_order_relaxed);
+                    suma[i].nu += c[Nu].load(std::memory_order_relaxed);
+                    suma[i].invalide += c[Invalide].load(std::memory_order_relaxed);
+                    suma[i].ghiciri_gresite += c[GhiciriGresite].load(std::memory_order_relaxed);
+                }
+            }
+            for (std::size_t faza = 0; faza < NUMAR_FAZE; ++faza) rezultat.timpi[faza].combina(fir->timpi[faza]);
+        }
+        return rezultat;
     }
 };
+#else
+class Metrici {
+public:
+    struct Moment {};
 
-// -----------------------------------------------------------
-// 5. JOC AKINATOR (CONTROLLER)
-// -----------------------------------------------------------
+    static bool esantion(FazaTimp) { return false; }
+    static Moment acum() { return {}; }
+    static std::uint64_t nsDeLa(Moment) { return 0; }
+    static void vizita(std::uint64_t, IndexNod, std::size_t) {}
+    static void raspuns(std::uint64_t, IndexNod, std::size_t, bool) {}
+    static void raspunsInvalid(std::uint64_t, IndexNod, std::size_t) {}
+    static void ghicireGresita(std::uint64_t, IndexNod, std::size_t) {}
+    static void timp(FazaTimp, std::uint64_t) {}
+    static void elibereaza(std::uint64_t) {}
+};
+#endif
 
-class JocAkinator {
+// Generatia unui arbore incarcat. Copiile arborelui (lectiile) impart acelasi obiect;
+// cand dispare ultima, contoarele generatiei se elibereaza.
+using Generatie = std::shared_ptr<const std::uint64_t>;
+
+inline Generatie urmatoareaGeneratie() {
+    static std::atomic<std::uint64_t> generatie{0};
+    const std::uint64_t numar = generatie.fetch_add(1, std::memory_order_relaxed) + 1;
+    return Generatie(new std::uint64_t(numar), [](const std::uint64_t* g) {
+        Metrici::elibereaza(*g);
+        delete g;
+    });
+}
+
+// Masoara o faza doar daca e activ (de obicei: Metrici::esantion(faza)).
+class Cronometru {
 private:
-    ManagerRaspunsuri manager_;
+    bool activ_;
+    Metrici::Moment start_;
 
 public:
-    JocAkinator() = default;
+    explicit Cronometru(bool activ) :
+        activ_(activ), start_(activ ? Metrici::acum() : Metrici::Moment{}) {}
 
-    void ruleazaSilentios(std::istream& is, std::ostream& os) {
-        std::string tema;
-
-        if (!(is >> tema)) {
-            os << "Eroare: Nu s-a putut citi tema din fisier." << std::endl;
-            return;
-        }
+    bool activ() const { return activ_; }
+    std::uint64_t ns() const { return activ_ ? Metrici::nsDeLa(start_) : 0; }
+    void inregistreaza(FazaTimp faza) const {
+        if (activ_) Metrici::timp(faza, ns());
+    }
+};
 
-        try {
-            manager_.selecteazaTema(tema);
+// Timpul unui joc, impartit in scrierea textului (iesire) si restul (parcurgere).
+// Se inregistreaza la distrugere, deci acopera si iesirile timpurii la erori.
+class MasuraJoc {
+private:
+    Cronometru total_{Metrici::esantion(FazaTimp::Parcurgere)};
+    std::uint64_t ns_iesire_ = 0;
 
-            const Entitate* rezultat = manager_.getArboreCurent()->determinaEntitatea(is, os);
+public:
+    MasuraJoc() = default;
+    MasuraJoc(const MasuraJoc&) = delete;
+    MasuraJoc& operator=(const MasuraJoc&) = delete;
 
-            if (rezultat != nullptr) {
-                os << rezultat->nume << "\n";
-            } else {
-                os << "Negasit\n";
-            }
-        } catch (const std::runtime_error& e) {
-            os << "Eroare: " << e.what() << "\n";
-        }
+    ~MasuraJoc() {
+        if (!total_.activ()) return;
+        const std::uint64_t total = total_.ns();
+        Metrici::timp(FazaTimp::Parcurgere, total - std::min(total, ns_iesire_));
+        Metrici::timp(FazaTimp::Iesire, ns_iesire_);
     }
 
+    bool activ() const { return total_.activ(); }
+    Cronometru iesire() const { return Cronometru(total_.activ()); }
+    void adaugaIesire(const Cronometru& c) { ns_iesire_ += c.ns(); }
 };
 
 // -----------------------------------------------------------
-// 6. MAIN FUNCTION
+// 3. ARBORE AKINATOR (MODEL)
 // -----------------------------------------------------------
 
-int main() {
-    std::ios_base::sync_with_stdio(false);
-    std::cin.tie(NULL);
-
-    std::ifstream is(FISIER_INTRARE);
-    std::ofstream os(FISIER_IESIRE);
+// Rezultatul ArboreAkinator::statistici(). Adancimea numara nodurile de pe drum, ca
+// in calculeazaAdancime (o frunza singura are adancimea 1); indicele 0 e radacina.
+struct StatisticiArbore {
+    std::size_t noduri = 0;
+    std::size_t frunze = 0;
+    std::size_t adancime = 0;
+    std::size_t suma_adancimi_frunze = 0;
+    std::vector<std::size_t> noduri_pe_nivel;
+    std::vector<std::size_t> frunze_pe_nivel;
 
-    if (!is.is_open() || !os.is_open()) {
-        std::cerr << "Eroare critica: Fisierele de I/O (tastatura.txt, raspuns.txt) nu sunt deschise corect." << std::endl;
-        return 1;
+    double adancimeMedieFrunze() const {
+        return frunze ? static_cast<double>(suma_adancimi_frunze) / static_cast<double>(frunze) : 0.0;
     }
+};
 
-    std::stringstream buffer;
+// Indexul entitatilor unui arbore: nume normalizat -> frunze (O(1)), parintele fiecarui
+// nod (drumul spre o frunza in O(adancime)) si cautarea dupa prefix. Se construieste
+// o data cu arborele (ArboreAkinator::indexeaza), in timp liniar, si ramane imutabil,
+// deci copiile arborelui il impart. Ordinea sortata a numelor, necesara doar pentru
+// prefix, se calculeaza la prima astfel de cautare.
+class IndexEntitati {
+private:
+    struct Grup {
+        SirPool nume;
+        std::uint32_t inceput;  // frunzele grupului: frunze_[inceput, inceput + numar)
+        std::uint32_t numar;
+    };
 
-    JocAkinator joc;
+    std::vector<IndexNod> parinti_;
+    std::string pool_;                      // numele normalizate distincte, puse cap la cap
+    std::vector<Grup> grupuri_;
+    std::vector<IndexNod> frunze_;
+    std::vector<std::uint32_t> tabela_;     // adresare deschisa: indici in grupuri_ (NOD_NUL = liber)
+    mutable std::once_flag sortare_;
+    mutable std::vector<std::uint32_t> ordine_;  // grupurile, sortate dupa nume
+
+    std::string_view nume(const Grup& g) const {
+        return std::string_view(pool_).substr(g.nume.offset, g.nume.lungime);
+    }
 
-    joc.ruleazaSilentios(is, buffer);
+    // Locul numelui normalizat in tabela: slotul lui sau primul slot liber.
+    std::size_t slot(std::string_view normalizat) const {
+        const std::size_t masca = tabela_.size() - 1;
+        for (std::size_t i = std::hash<std::string_view>{}(normalizat) & masca;; i = (i + 1) & masca) {
+            if (tabela_[i] == NOD_NUL || nume(grupuri_[tabela_[i]]) == normalizat) return i;
+        }
+    }
+
+public:
+    // frunze: (frunza, numele ei asa cum apare in arbore), in ordinea parcurgerii.
+    IndexEntitati(std::vector<IndexNod> parinti, std::span<const std::pair<IndexNod, std::string_view>> frunze) :
+        parinti_(std::move(parinti)) {
+        std::size_t capacitate = 16;
+        while (capacitate < 2 * frunze.size()) capacitate *= 2;
+        tabela_.assign(capacitate, NOD_NUL);
 
-    os << buffer.str();
+        // Pasul 1: grupul fiecarei frunze si marimea grupurilor.
+        std::vector<std::uint32_t> grup_frunza(frunze.size());
+        std::string normalizat;
+        for (std::size_t i = 0; i < frunze.size(); ++i) {
+            normalizat.clear();
+            normalizeazaNume(frunze[i].second, normalizat);
+            const std::size_t s = slot(normalizat);
+            if (tabela_[s] == NOD_NUL) {
+                tabela_[s] = static_cast<std::uint32_t>(grupuri_.size());
+                grupuri_.push_back({{static_cast<std::uint32_t>(pool_.size()), static_cast<std::uint32_t>(normalizat.size())}, 0, 0});
+                pool_ += normalizat;
+            }
+            grup_frunza[i] = tabela_[s];
+            ++grupuri_[tabela_[s]].numar;
+        }
+
+        // Pasul 2: frunzele asezate pe grupuri (sortare prin numarare).
+        std::uint32_t inceput = 0;
+        for (Grup& g : grupuri_) {
+            g.inceput = inceput;
+            inceput += g.numar;
+            g.numar = 0;
+        }
+        frunze_.resize(frunze.size());
+        for (std::size_t i = 0; i < frunze.size(); ++i) {
+            Grup& g = grupuri_[grup_frunza[i]];
+            frunze_[g.inceput + g.numar++] = frunze[i].first;
+        }
+    }
+
+    IndexEntitati(const IndexEntitati&) = delete;
+    IndexEntitati& operator=(const IndexEntitati&) = delete;
+
+    IndexNod parinte(IndexNod nod) const { return nod < parinti_.size() ? parinti_[nod] : NOD_NUL; }
+    std::size_t numarNume() const { return grupuri_.size(); }
+
+    // Frunzele cu numele dat (oricum ar fi scris: cu sau fara diacritice, majuscule).
+    std::span<const IndexNod> frunze(std::string_view nume) const {
+        const std::uint32_t g = tabela_[slot(normalizeazaNume(nume))];
+        if (g == NOD_NUL) return {};
+        return std::span<const IndexNod>(frunze_).subspan(grupuri_[g].inceput, grupuri_[g].numar);
+    }
+
+    // Cate o frunza pentru fiecare nume care incepe cu prefixul, in ordinea numelor.
+    std::vector<IndexNod> cautaDupaPrefix(std::string_view prefix, std::size_t limita) const {
+        std::call_once(sortare_, [this] {
+            ordine_.resize(grupuri_.size());
+            for (std::uint32_t g = 0; g < ordine_.size(); ++g) ordine_[g] = g;
+            std::sort(ordine_.begin(), ordine_.end(), [this](std::uint32_t a, std::uint32_t b) {
+                return nume(grupuri_[a]) < nume(grupuri_[b]);
+            });
+        });
+
+        const std::string p = normalizeazaNume(prefix);
+        std::vector<IndexNod> rezultat;
+        auto it = std::partition_point(ordine_.begin(), ordine_.end(), [&](std::uint32_t g) { return nume(grupuri_[g]) < p; });
+        for (; it != ordine_.end() && rezultat.size() < limita && nume(grupuri_[*it]).starts_with(p); ++it) {
+            rezultat.push_back(frunze_[grupuri_[*it].inceput]);
+        }
+        return rezultat;
+    }
+};
+
+class ArboreAkinator {
+private:
+    std::vector<Nod> noduri_;
+    std::vector<DateEntitate> entitati_;
+    std::string pool_;                  // toate textele, fiecare sir distinct o singura data
+    std::shared_ptr<const ImagineBinara> imagine_;  // daca e setat, inlocuieste cele trei de mai sus
+    IndexNod radacina_ = NOD_NUL;
+    std::string tema_;
+    Generatie generatie_;               // noua la fiecare incarcare; lectiile o pastreaza
+    std::shared_ptr<const IndexEntitati> index_;  // vezi indexeaza()
+
+    friend class OptimizatorArbore;  // construieste o arena noua direct, ca ConstructorSAX
+    friend class GeneratorArbore;
+
+    // Tot ce citeste arborele trece prin aceste vederi, indiferent de unde vine memoria.
+    std::span<const Nod> noduri() const { return imagine_ ? imagine_->noduri : std::span<const Nod>(noduri_); }
+    std::span<const DateEntitate> entitati() const { return imagine_ ? imagine_->entitati : std::span<const DateEntitate>(entitati_); }
+    std::string_view pool() const { return imagine_ ? imagine_->pool : std::string_view(pool_); }
+
+    // Folosit doar la constructie: multimea sirurilor deja puse in pool_. Tine doar
+    // referinte (offset, lungime), comparate prin pool, ca sa nu dubleze textele.
+    struct ComparaSir {
+        using is_transparent = void;
+        const std::string* pool;
+
+        std::string_view text(SirPool s) const { return std::string_view(*pool).substr(s.offset, s.lungime); }
+        std::string_view text(std::string_view s) const { return s; }
+
+        template <typename A>
+        std::size_t operator()(const A& a) const { return std::hash<std::string_view>{}(text(a)); }
+        template <typename A, typename B>
+        bool operator()(const A& a, const B& b) const { return text(a) == text(b); }
+    };
+    using TabelaInternare = std::unordered_set<SirPool, ComparaSir, ComparaSir>;
+
+    TabelaInternare tabelaNoua() const {
+        return TabelaInternare(0, ComparaSir{&pool_}, ComparaSir{&pool_});
+    }
+
+    std::string_view sir(SirPool s) const {
+        return pool().substr(s.offset, s.lungime);
+    }
+
+    SirPool interneaza(std::string_view s, TabelaInternare& tabela) {
+        if (auto it = tabela.find(s); it != tabela.end()) return *it;
+        const SirPool ref = adaugaSir(s);
+        tabela.insert(ref);
+        return ref;
+    }
+
+    // s nu trebuie sa fie o vedere in pool_ (append-ul il poate realoca).
+    SirPool adaugaSir(std::string_view s) {
+        if (pool_.size() + s.size() > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error("Pool-ul de siruri al temei " + tema_ + " depaseste 4 GiB.");
+        }
+        SirPool ref{static_cast<std::uint32_t>(pool_.size()), static_cast<std::uint32_t>(s.size())};
+        pool_.append(s);
+        return ref;
+    }
+
+    IndexNod adaugaNod(const Nod& n) {
+        if (noduri_.size() >= NOD_NUL) {
+            throw std::runtime_error("Arborele temei " + tema_ + " are prea multe noduri.");
+        }
+        noduri_.push_back(n);
+        return static_cast<IndexNod>(noduri_.size() - 1);
+    }
+
+    // Un nod e fie frunza ("entitate"), fie intrebare ("intrebare", "da", "nu"); o
+    // ramura goala e null. Ambele incarcatoare resping nodurile care amesteca cele doua
+    // forme sau nu au niciuna, deci dau aceeasi arena.
+    static constexpr const char* MESAJ_FRUNZA_CU_COPII = "un nod cu \"entitate\" nu poate avea \"intrebare\", \"da\" sau \"nu\"";
+    static constexpr const char* MESAJ_NOD_GOL = "un nod trebuie sa aiba \"intrebare\" sau \"entitate\" (ramura goala se scrie null)";
+
+    // Fara recursie: stiva tine obiectele JSON inca neparcurse si unde se leaga fiecare.
+    // "da" se scoate inaintea lui "nu", deci nodurile se aloca tot in preordine.
+    IndexNod parsezNodJSON(const json& radacina, TabelaInternare& tabela) {
+        struct Cadru {
+            const json* j;
+            IndexNod parinte;
+            bool da;
+        };
+        IndexNod rezultat = NOD_NUL;
+        std::vector<Cadru> stiva{{&radacina, NOD_NUL, false}};
+        while (!stiva.empty()) {
+            const Cadru c = stiva.back();
+            stiva.pop_back();
+            const json& j = *c.j;
+
+            IndexNod index = NOD_NUL;
+            if (j.is_null()) {
+                // ramura goala
+            } else if (j.contains("entitate")) {
+                if (j.contains("intrebare") || j.contains("da") || j.contains("nu")) {
+                    throw std::runtime_error(MESAJ_FRUNZA_CU_COPII);
+                }
+                const auto& entitate_json = j.at("entitate");
+                Nod frunza;
+                frunza.text = interneaza(entitate_json.at("nume").get_ref<const std::string&>(), tabela);
+                frunza.entitate = static_cast<std::uint32_t>(entitati_.size());
+                entitati_.push_back({
+                    interneaza(entitate_json.at("domeniu").get_ref<const std::string&>(), tabela),
+                    interneaza(entitate_json.at("tip").get_ref<const std::string&>(), tabela)
+                });
+                index = adaugaNod(frunza);
+            } else if (j.contains("intrebare")) {
+                Nod intern;
+                intern.text = interneaza(j.at("intrebare").get_ref<const std::string&>(), tabela);
+                index = adaugaNod(intern);
+                if (j.contains("nu")) stiva.push_back({&j.at("nu"), index, false});
+                if (j.contains("da")) stiva.push_back({&j.at("da"), index, true});
+            } else if (j.is_object()) {
+                throw std::runtime_error(MESAJ_NOD_GOL);
+            }
+
+            // Copiii se leaga prin index: vectorul se poate realoca intre timp.
+            if (c.parinte == NOD_NUL) {
+                rezultat = index;
+            } else if (c.da) {
+                noduri_[c.parinte].da = index;
+            } else {
+                noduri_[c.parinte].nu = index;
+            }
+        }
+        return rezultat;
+    }
+
+    // Construieste arena direct din evenimentele SAX, fara DOM intermediar si fara
+    // recursie: fiecare obiect JSON deschis are un cadru pe stiva explicita.
+    // Nodurile se aloca in preordine, exact ca in parsezNodJSON, deci arena rezultata
+    // (si fisierul .akb scris din ea) nu depinde de incarcatorul folosit.
+    class ConstructorSAX {
+    private:
+        enum class Cadru : std::uint8_t { Document, Nod, Entitate, Ignorat };
+        enum class Camp : std::uint8_t { Nimic, Ignora, Radacina, Intrebare, Da, Nu, Entitate, Nume, Domeniu, Tip };
+
+        struct Stare {
+            explicit Stare(Cadru c) : cadru(c) {}
+
+            Cadru cadru;
+            Camp asteapta = Camp::Nimic;
+            IndexNod nod = NOD_NUL;         // pentru Nod: nodul construit
+            IndexNod parinte = NOD_NUL;     // pentru Nod: de unde a fost legat
+            Camp legatura = Camp::Nimic;    // Radacina, Da sau Nu
+            bool are_intrebare = false;
+            bool are_copii = false;         // cheia "da" sau "nu", chiar si cu valoare null
+            bool are_entitate = false;
+            bool are_nume = false;
+            bool are_domeniu = false;
+            bool are_tip = false;
+            SirPool nume;
+            DateEntitate date;
+        };
+
+        ArboreAkinator& arbore_;
+        TabelaInternare tabela_;  // se refera la arbore_.pool_
+        std::vector<Stare> stiva_;
+        std::istream& sursa_;
+        const std::string& fisier_;
+        bool are_radacina_ = false;
+
+        [[noreturn]] void eroare(const std::string& mesaj) const {
+            const auto pozitie = sursa_.rdbuf()->pubseekoff(0, std::ios::cur, std::ios::in);
+            throw std::runtime_error("Eroare in " + fisier_ + " la octetul " + std::to_string(static_cast<long long>(pozitie)) + ": " + mesaj);
+        }
+
+        // Campul pentru care soseste valoarea curenta; il consuma.
+        Camp campCurent() {
+            if (stiva_.empty()) return Camp::Nimic;
+            return std::exchange(stiva_.back().asteapta, Camp::Nimic);
+        }
+
+        void legaNod(Camp legatura, IndexNod parinte, IndexNod copil) {
+            if (legatura == Camp::Radacina) {
+                arbore_.radacina_ = copil;
+            } else if (legatura == Camp::Da) {
+                arbore_.noduri_[parinte].da = copil;
+            } else {
+                arbore_.noduri_[parinte].nu = copil;
+            }
+        }
+
+        // Valorile care nu sunt obiecte si nici siruri asteptate.
+        bool scalar(const char* tip) {
+            switch (campCurent()) {
+                case Camp::Intrebare:
+                case Camp::Nume:
+                case Camp::Domeniu:
+                case Camp::Tip:
+                    eroare(std::string("se astepta un sir, nu ") + tip);
+                case Camp::Entitate:
+                    eroare(std::string("\"entitate\" trebuie sa fie obiect, nu ") + tip);
+                case Camp::Nimic:
+                    if (stiva_.empty()) eroare("documentul trebuie sa fie un obiect");
+                    return true;
+                default:
+                    // "da"/"nu"/"radacina" care nu sunt obiecte nu duc nicaieri, ca in parsezNodJSON.
+                    return true;
+            }
+        }
+
+    public:
+        ConstructorSAX(ArboreAkinator& arbore, std::istream& sursa, const std::string& fisier) :
+            arbore_(arbore), tabela_(arbore.tabelaNoua()), sursa_(sursa), fisier_(fisier) {}
+
+        bool areRadacina() const { return are_radacina_; }
+
+        bool null() { return scalar("null"); }
+        bool boolean(bool) { return scalar("boolean"); }
+        bool number_integer(json::number_integer_t) { return scalar("numar"); }
+        bool number_unsigned(json::number_unsigned_t) { return scalar("numar"); }
+        bool number_float(json::number_float_t, const json::string_t&) { return scalar("numar"); }
+        bool binary(json::binary_t&) { return scalar("binar"); }
+
+        bool string(json::string_t& valoare) {
+            const Camp camp = campCurent();
+            if (camp == Camp::Intrebare) {
+                Stare& s = stiva_.back();
+                arbore_.noduri_[s.nod].text = arbore_.interneaza(valoare, tabela_);
+                s.are_intrebare = true;
+                return true;
+            }
+            if (camp == Camp::Nume || camp == Camp::Domeniu || camp == Camp::Tip) {
+                Stare& s = stiva_.back();
+                const SirPool ref = arbore_.interneaza(valoare, tabela_);
+                if (camp == Camp::Nume) { s.nume = ref; s.are_nume = true; }
+                else if (camp == Camp::Domeniu) { s.date.domeniu = ref; s.are_domeniu = true; }
+                else { s.date.tip = ref; s.are_tip = true; }
+                return true;
+            }
+            return scalar("sir");
+        }
+
+        bool start_object(std::size_t) {
+            const Camp camp = campCurent();
+            if (stiva_.empty()) {
+                stiva_.emplace_back(Cadru::Document);
+                return true;
+            }
+            if (camp == Camp::Radacina || camp == Camp::Da || camp == Camp::Nu) {
+                const IndexNod parinte = stiva_.back().nod;
+                const IndexNod nod = arbore_.adaugaNod(Nod{});
+                legaNod(camp, parinte, nod);
+                if (camp == Camp::Radacina) are_radacina_ = true;
+                Stare s(Cadru::Nod);
+                s.nod = nod;
+                s.parinte = parinte;
+                s.legatura = camp;
+                stiva_.push_back(s);
+                return true;
+            }
+            if (camp == Camp::Entitate) {
+                stiva_.emplace_back(Cadru::Entitate);
+                return true;
+            }
+            if (camp != Camp::Ignora) scalar("obiect");
+            stiva_.emplace_back(Cadru::Ignorat);
+            return true;
+        }
+
+        bool key(json::string_t& cheie) {
+            Stare& s = stiva_.back();
+            Camp camp = Camp::Ignora;
+            switch (s.cadru) {
+                case Cadru::Document:
+                    if (cheie == "radacina") camp = Camp::Radacina;
+                    break;
+                case Cadru::Nod:
+                    if (cheie == "intrebare") camp = Camp::Intrebare;
+                    else if (cheie == "da") camp = Camp::Da;
+                    else if (cheie == "nu") camp = Camp::Nu;
+                    else if (cheie == "entitate") camp = Camp::Entitate;
+                    if (camp == Camp::Da || camp == Camp::Nu) s.are_copii = true;
+                    break;
+                case Cadru::Entitate:
+                    if (cheie == "nume") camp = Camp::Nume;
+                    else if (cheie == "domeniu") camp = Camp::Domeniu;
+                    else if (cheie == "tip") camp = Camp::Tip;
+                    break;
+                case Cadru::Ignorat:
+                    break;
+            }
+            s.asteapta = camp;
+            return true;
+        }
+
+        bool end_object() {
+            const Stare s = stiva_.back();
+            stiva_.pop_back();
+
+            if (s.cadru == Cadru::Entitate) {
+                if (!s.are_nume || !s.are_domeniu || !s.are_tip) {
+                    eroare("entitatea trebuie sa aiba \"nume\", \"domeniu\" si \"tip\"");
+                }
+                Stare& parinte = stiva_.back();
+                parinte.are_entitate = true;
+                parinte.nume = s.nume;
+                parinte.date = s.date;
+            } else if (s.cadru == Cadru::Nod) {
+                Nod& n = arbore_.noduri_[s.nod];
+                if (s.are_entitate) {
+                    if (s.are_intrebare || s.are_copii) eroare(MESAJ_FRUNZA_CU_COPII);
+                    n.text = s.nume;
+                    n.entitate = static_cast<std::uint32_t>(arbore_.entitati_.size());
+                    arbore_.entitati_.push_back(s.date);
+                } else if (!s.are_intrebare) {
+                    eroare(MESAJ_NOD_GOL);
+                }
+            }
+            return true;
+        }
+
+        bool start_array(std::size_t) {
+            const Camp camp = campCurent();
+            if (camp != Camp::Ignora && camp != Camp::Radacina && camp != Camp::Da && camp != Camp::Nu) {
+                scalar("lista");
+            }
+            stiva_.emplace_back(Cadru::Ignorat);
+            return true;
+        }
+
+        bool end_array() {
+            stiva_.pop_back();
+            return true;
+        }
+
+        bool parse_error(std::size_t pozitie, const std::string&, const nlohmann::detail::exception& e) {
+            throw std::runtime_error("Eroare la parsarea JSON din " + fisier_ + " la octetul " + std::to_string(pozitie) + ": " + e.what());
+        }
+    };
+
+    // Parcurgere in preordine ("da" inaintea lui "nu") cu stiva explicita, deci fara
+    // limita de adancime; vizita primeste indexul, nodul si nivelul lui (radacina are 1).
+    template <typename Vizita>
+    void parcurge(Vizita&& vizita) const {
+        if (radacina_ == NOD_NUL) return;
+        const std::span<const Nod> n = noduri();
+        std::vector<std::pair<IndexNod, std::size_t>> stiva{{radacina_, 1}};
+        while (!stiva.empty()) {
+            const auto [index, nivel] = stiva.back();
+            stiva.pop_back();
+            const Nod& nod = n[index];
+            vizita(index, nod, nivel);
+            if (nod.nu != NOD_NUL) stiva.emplace_back(nod.nu, nivel + 1);
+            if (nod.da != NOD_NUL) stiva.emplace_back(nod.da, nivel + 1);
+        }
+    }
+
+public:
+    // CORECTIE Cppcheck: Adăugăm explicit
+    explicit ArboreAkinator(std::string tema) : tema_(std::move(tema)) {}
+    ArboreAkinator() : tema_("Necunoscuta") {}
+
+    // R3: DESTRUCTOR (arena se elibereaza in trei dealocari, fara parcurgere)
+    ~ArboreAkinator() = default;
+
+    // R3: CONSTRUCTOR DE COPIERE (copiere liniara a arenei, fara alocari per nod)
+    ArboreAkinator(const ArboreAkinator& other) :
+        noduri_(other.noduri_),
+        entitati_(other.entitati_),
+        pool_(other.pool_),
+        imagine_(other.imagine_),
+        radacina_(other.radacina_),
+        tema_(other.tema_),
+        generatie_(other.generatie_),
+        index_(other.index_)
+    {}
+
+    // R3: OPERATOR DE ATRIBUIRE
+    ArboreAkinator& operator=(ArboreAkinator other) {
+        schimba(other);
+        return *this;
+    }
+
+    void schimba(ArboreAkinator& other) noexcept {
+        std::swap(noduri_, other.noduri_);
+        std::swap(entitati_, other.entitati_);
+        std::swap(pool_, other.pool_);
+        std::swap(imagine_, other.imagine_);
+        std::swap(radacina_, other.radacina_);
+        std::swap(tema_, other.tema_);
+        std::swap(generatie_, other.generatie_);
+        std::swap(index_, other.index_);
+    }
+
+    // Deplasare
+    ArboreAkinator(ArboreAkinator&& other) noexcept = default;
+    ArboreAkinator& operator=(ArboreAkinator&& other) noexcept = default;
+
+
+    // Incarcatorul principal: streaming SAX, memorie de varf ~ arena finala, fara
+    // limita de adancime a arborelui. La eroare arborele curent ramane neschimbat.
+    void incarcaDinFisier(const std::string& nume_fisier) {
+        std::ifstream f(nume_fisier, std::ios::binary);
+        if (!f.is_open()) {
+             return;
+        }
+
+        ArboreAkinator nou(tema_);
+        ConstructorSAX constructor(nou, f, nume_fisier);
+        json::sax_parse(f, &constructor);
+        if (constructor.areRadacina()) {
+            nou.noduri_.shrink_to_fit();
+            nou.entitati_.shrink_to_fit();
+            nou.pool_.shrink_to_fit();
+            nou.generatie_ = urmatoareaGeneratie();
+            nou.indexeaza();
+            schimba(nou);
+        }
+    }
+
+    // Incarcatorul vechi, prin DOM nlohmann; pastrat ca referinta pentru comparatii
+    // (randul incarca_json_dom din --benchmark, langa incarca_json).
+    void incarcaDinFisierDOM(const std::string& nume_fisier) {
+        std::ifstream f(nume_fisier);
+        if (!f.is_open()) {
+             return;
+        }
+
+        try {
+            json data = json::parse(f);
+            if (data.contains("radacina")) {
+                noduri_.clear();
+                entitati_.clear();
+                pool_.clear();
+                imagine_.reset();
+                TabelaInternare tabela = tabelaNoua();
+                radacina_ = parsezNodJSON(data.at("radacina"), tabela);
+                noduri_.shrink_to_fit();
+                entitati_.shrink_to_fit();
+                pool_.shrink_to_fit();
+                generatie_ = urmatoareaGeneratie();
+                indexeaza();
+            }
+        } catch (json::exception& e) {
+             throw std::runtime_error("Eroare la parsarea JSON din " + nume_fisier + ": " + e.what());
+        } catch (const std::runtime_error& e) {
+             throw std::runtime_error("Eroare in " + nume_fisier + ": " + e.what());
+        }
+    }
+
+    // Verifica fiecare index din imagine: copiii sunt noduri existente sau NOD_NUL,
+    // frunzele au o entitate existenta si niciun copil, sirurile sunt in pool, iar
+    // nodurile formeaza un singur arbore din radacina (cel mult un parinte pe nod,
+    // radacina fara parinte si toate nodurile atinse, deci fara cicluri).
+    static void valideazaImagine(const ImagineBinara& imagine, IndexNod radacina, const std::string& nume_fisier) {
+        const std::size_t numar = imagine.noduri.size();
+        auto invalid = [&](const std::string& motiv) {
+            return std::runtime_error("Arbore binar invalid in " + nume_fisier + ": " + motiv);
+        };
+        auto inPool = [&](SirPool s) {
+            return std::uint64_t{s.offset} + s.lungime <= imagine.pool.size();
+        };
+        std::vector<std::uint8_t> parinti(numar, 0);
+        auto leaga = [&](IndexNod copil, std::size_t parinte) {
+            if (copil == NOD_NUL) return;
+            if (copil >= numar) throw invalid("nodul " + std::to_string(parinte) + " are un copil inexistent");
+            if (copil == radacina) throw invalid("radacina apare drept copilul nodului " + std::to_string(parinte));
+            if (parinti[copil]++ != 0) {
+                throw invalid("nodul " + std::to_string(copil) + " are mai multi parinti");
+            }
+        };
+
+        for (std::size_t i = 0; i < numar; ++i) {
+            const Nod& n = imagine.noduri[i];
+            if (!inPool(n.text)) throw invalid("textul nodului " + std::to_string(i) + " iese din pool");
+            if (n.esteFrunza()) {
+                if (n.entitate >= imagine.entitati.size()) throw invalid("frunza " + std::to_string(i) + " are o entitate inexistenta");
+                if (n.da != NOD_NUL || n.nu != NOD_NUL) throw invalid("frunza " + std::to_string(i) + " are copii");
+                const DateEntitate& e = imagine.entitati[n.entitate];
+                if (!inPool(e.domeniu) || !inPool(e.tip)) throw invalid("entitatea frunzei " + std::to_string(i) + " iese din pool");
+            }
+            leaga(n.da, i);
+            leaga(n.nu, i);
+        }
+
+        // Cu cel mult un parinte pe nod si radacina fara parinte, partea atinsa din
+        // radacina e un arbore; orice nod neatins ar fi orfan sau intr-un ciclu.
+        std::size_t atinse = 0;
+        std::vector<IndexNod> stiva;
+        if (radacina != NOD_NUL) stiva.push_back(radacina);
+        while (!stiva.empty()) {
+            const Nod& n = imagine.noduri[stiva.back()];
+            stiva.pop_back();
+            ++atinse;
+            if (n.da != NOD_NUL) stiva.push_back(n.da);
+            if (n.nu != NOD_NUL) stiva.push_back(n.nu);
+        }
+        if (atinse != numar) throw invalid(std::to_string(numar - atinse) + " noduri nu se pot atinge din radacina");
+    }
+
+    // Proiecteaza un fisier .akb si il parcurge pe loc, fara copiere. Antetul, suma de
+    // control si apoi fiecare index din fisier (valideazaImagine) se verifica inainte
+    // ca arborele sa fie folosit.
+    void incarcaDinFisierBinar(const std::string& nume_fisier) {
+        auto fisier = std::make_shared<const FisierMapat>(nume_fisier);
+        const std::byte* date = fisier->date();
+        const std::size_t lungime = fisier->lungime();
+
+        AntetBinar antet{};
+        if (lungime < sizeof(antet)) {
+            throw std::runtime_error("Fisier binar trunchiat: " + nume_fisier);
+        }
+        std::memcpy(&antet, date, sizeof(antet));
+        if (std::memcmp(antet.magic, MAGIC_BINAR, sizeof(MAGIC_BINAR)) != 0) {
+            throw std::runtime_error("Fisierul " + nume_fisier + " nu este un arbore binar Akinator.");
+        }
+        if constexpr (std::endian::native != std::endian::little) {
+            throw std::runtime_error("Formatul binar este little-endian; foloseste " + nume_fisier + " in format JSON.");
+        }
+        if (antet.versiune != VERSIUNE_BINAR) {
+            throw std::runtime_error("Versiune necunoscuta (" + std::to_string(antet.versiune) + ") in " + nume_fisier);
+        }
+        const std::size_t octeti_noduri = std::size_t{antet.numar_noduri} * sizeof(Nod);
+        const std::size_t octeti_entitati = std::size_t{antet.numar_entitati} * sizeof(DateEntitate);
+        if (lungime != sizeof(antet) + octeti_noduri + octeti_entitati + antet.lungime_pool) {
+            throw std::runtime_error("Dimensiune incoerenta in " + nume_fisier);
+        }
+        const std::byte* continut = date + sizeof(antet);
+        if (sumaControl(continut, lungime - sizeof(antet)) != antet.suma_control) {
+            throw std::runtime_error("Suma de control gresita in " + nume_fisier);
+        }
+        if (antet.radacina != NOD_NUL && antet.radacina >= antet.numar_noduri) {
+            throw std::runtime_error("Radacina invalida in " + nume_fisier);
+        }
+
+        auto imagine = std::make_shared<ImagineBinara>();
+        imagine->noduri = {reinterpret_cast<const Nod*>(continut), antet.numar_noduri};
+        imagine->entitati = {reinterpret_cast<const DateEntitate*>(continut + octeti_noduri), antet.numar_entitati};
+        imagine->pool = {reinterpret_cast<const char*>(continut + octeti_noduri + octeti_entitati), antet.lungime_pool};
+        imagine->fisier = std::move(fisier);
+        valideazaImagine(*imagine, antet.radacina, nume_fisier);
+
+        noduri_ = {};
+        entitati_ = {};
+        pool_ = {};
+        imagine_ = std::move(imagine);
+        radacina_ = antet.radacina;
+        generatie_ = urmatoareaGeneratie();
+        indexeaza();
+    }
+
+    void salveazaBinar(const std::string& nume_fisier) const {
+        const auto n = noduri();
+        const auto e = entitati();
+        const auto p = pool();
+
+        std::vector<std::byte> continut(n.size_bytes() + e.size_bytes() + p.size());
+        if (!n.empty()) std::memcpy(continut.data(), n.data(), n.size_bytes());
+        if (!e.empty()) std::memcpy(continut.data() + n.size_bytes(), e.data(), e.size_bytes());
+        if (!p.empty()) std::memcpy(continut.data() + n.size_bytes() + e.size_bytes(), p.data(), p.size());
+
+        AntetBinar antet{};
+        std::memcpy(antet.magic, MAGIC_BINAR, sizeof(MAGIC_BINAR));
+        antet.versiune = VERSIUNE_BINAR;
+        antet.radacina = radacina_;
+        antet.numar_noduri = static_cast<std::uint32_t>(n.size());
+        antet.numar_entitati = static_cast<std::uint32_t>(e.size());
+        antet.lungime_pool = static_cast<std::uint32_t>(p.size());
+        antet.suma_control = sumaControl(continut.data(), continut.size());
+
+        // Scriem alaturi si redenumim: jocurile care au deja fisierul vechi mapat nu il vad trunchiat.
+        const std::string temporar = nume_fisier + "." + std::to_string(idProces()) + ".tmp";
+        {
+            std::ofstream f(temporar, std::ios::binary | std::ios::trunc);
+            if (!f.is_open()) {
+                throw std::runtime_error("Nu se poate scrie " + temporar);
+            }
+            f.write(reinterpret_cast<const char*>(&antet), sizeof(antet));
+            f.write(reinterpret_cast<const char*>(continut.data()), static_cast<std::streamsize>(continut.size()));
+            if (!f) {
+                throw std::runtime_error("Scriere incompleta in " + temporar);
+            }
+        }
+        std::filesystem::rename(temporar, nume_fisier);
+    }
+
+    // Aceeasi forma ca fisierele scrise de mana (frunzele pe cate o linie), scrisa fara
+    // recursie. Indentarea se opreste la o adancime fixa, ca un lant foarte adanc sa dea
+    // tot un fisier de dimensiune liniara.
+    void salveazaJSON(const std::string& nume_fisier) const {
+        constexpr std::size_t INDENTARE_MAXIMA = 16;
+        const std::string spatii(2 * INDENTARE_MAXIMA, ' ');
+        auto indentare = [&](std::size_t nivel) {
+            return std::string_view(spatii).substr(0, 2 * std::min(nivel, INDENTARE_MAXIMA));
+        };
+
+        const std::string temporar = nume_fisier + "." + std::to_string(idProces()) + ".tmp";
+        {
+            std::ofstream f(temporar, std::ios::binary | std::ios::trunc);
+            if (!f.is_open()) {
+                throw std::runtime_error("Nu se poate scrie " + temporar);
+            }
+            f << "{\n  \"tema\": ";
+            scrieSirJSON(f, tema_);
+            f << ",\n  \"radacina\": ";
+
+            // etapa 0: nodul inca nescris; 1: dupa ramura "da"; 2: dupa ramura "nu".
+            struct Cadru {
+                IndexNod nod;
+                std::size_t nivel;
+                std::uint8_t etapa;
+            };
+            std::vector<Cadru> stiva{{radacina_, 1, 0}};
+            while (!stiva.empty()) {
+                Cadru& c = stiva.back();
+                if (c.nod == NOD_NUL) {
+                    f << "null";
+                    stiva.pop_back();
+                    continue;
+                }
+                const Nod& n = noduri()[c.nod];
+                if (n.esteFrunza()) {
+                    const Entitate e = entitate(c.nod);
+                    f << "{ \"entitate\": { \"nume\": ";
+                    scrieSirJSON(f, e.nume);
+                    f << ", \"domeniu\": ";
+                    scrieSirJSON(f, e.domeniu);
+                    f << ", \"tip\": ";
+                    scrieSirJSON(f, e.tip);
+                    f << " } }";
+                    stiva.pop_back();
+                    continue;
+                }
+                const std::string_view ind = indentare(c.nivel + 1);
+                const std::size_t nivel = c.nivel + 1;
+                if (c.etapa == 0) {
+                    f << "{\n" << ind << "\"intrebare\": ";
+                    scrieSirJSON(f, sir(n.text));
+                    f << ",\n" << ind << "\"da\": ";
+                    c.etapa = 1;
+                    stiva.push_back({n.da, nivel, 0});
+                } else if (c.etapa == 1) {
+                    f << ",\n" << ind << "\"nu\": ";
+                    c.etapa = 2;
+                    stiva.push_back({n.nu, nivel, 0});
+                } else {
+                    f << '\n' << indentare(c.nivel) << '}';
+                    stiva.pop_back();
+                }
+            }
+            f << "\n}\n";
+            if (!f) {
+                throw std::runtime_error("Scriere incompleta in " + temporar);
+            }
+        }
+        std::filesystem::rename(temporar, nume_fisier);
+    }
+
+    Entitate entitate(IndexNod frunza) const {
+        const Nod& n = noduri()[frunza];
+        const DateEntitate& d = entitati()[n.entitate];
+        return {sir(n.text), sir(d.domeniu), sir(d.tip)};
+    }
+
+    // Un arbore citit dintr-un .akb se copiaza in vectori proprii inainte de modificare.
+    void materializeaza() {
+        if (!imagine_) return;
+        const auto n = noduri();
+        const auto e = entitati();
+        const auto p = pool();
+        noduri_.assign(n.begin(), n.end());
+        entitati_.assign(e.begin(), e.end());
+        pool_.assign(p);
+        imagine_.reset();
+    }
+
+    // Nodul la care duce un sir de raspunsuri 'd'/'n', sau NOD_NUL.
+    IndexNod nodLaCale(std::string_view cale) const {
+        IndexNod curent = radacina_;
+        for (const char pas : cale) {
+            if (curent == NOD_NUL) return NOD_NUL;
+            const Nod& n = noduri()[curent];
+            if (n.esteFrunza() || (pas != 'd' && pas != 'n')) return NOD_NUL;
+            curent = pas == 'd' ? n.da : n.nu;
+        }
+        return curent;
+    }
+
+    // Frunza devine intrebarea lectiei, iar vechea entitate si cea noua devin copiii ei.
+    // Se adauga doar la capatul arenei, deci indicii nodurilor existente nu se schimba.
+    void invata(IndexNod frunza, const Lectie& lectie) {
+        materializeaza();
+        if (frunza >= noduri_.size() || !noduri_[frunza].esteFrunza()) {
+            throw std::runtime_error("Lectia trebuie aplicata la o entitate, nu la o intrebare.");
+        }
+
+        Nod noua;
+        noua.text = adaugaSir(lectie.nume);
+        noua.entitate = static_cast<std::uint32_t>(entitati_.size());
+        entitati_.push_back({adaugaSir(lectie.domeniu), adaugaSir(lectie.tip)});
+        const SirPool intrebare = adaugaSir(lectie.intrebare);
+
+        const IndexNod veche = adaugaNod(noduri_[frunza]);
+        const IndexNod nou = adaugaNod(noua);
+        Nod& intern = noduri_[frunza];
+        intern.text = intrebare;
+        intern.entitate = NOD_NUL;
+        intern.da = lectie.raspuns_da ? nou : veche;
+        intern.nu = lectie.raspuns_da ? veche : nou;
+        index_.reset();  // refacut de apelant cu indexeaza(), o data dupa un lot de lectii
+    }
+
+    // (Re)construieste indexul entitatilor: o parcurgere plus o sortare a numelor.
+    // Incarcarile il construiesc singure; dupa invata() il reface apelantul.
+    void indexeaza() {
+        std::vector<IndexNod> parinti(noduri().size(), NOD_NUL);
+        std::vector<std::pair<IndexNod, std::string_view>> frunze;
+        frunze.reserve(entitati().size());
+        parcurge([&](IndexNod index, const Nod& nod, std::size_t) {
+            if (nod.esteFrunza()) {
+                frunze.emplace_back(index, sir(nod.text));
+                return;
+            }
+            if (nod.da != NOD_NUL) parinti[nod.da] = index;
+            if (nod.nu != NOD_NUL) parinti[nod.nu] = index;
+        });
+        index_ = std::make_shared<const IndexEntitati>(std::move(parinti), frunze);
+    }
+
+    const IndexEntitati& index() const {
+        if (index_) return *index_;
+        if (radacina_ == NOD_NUL) {
+            static const IndexEntitati gol({}, {});
+            return gol;
+        }
+        throw std::runtime_error("Indexul temei " + tema_ + " nu e construit (lipseste indexeaza() dupa invata()).");
+    }
+
+    bool contineEntitatea(std::string_view nume) const { return !index().frunze(nume).empty(); }
+
+    // Intrebarile si raspunsurile care duc din radacina la nod, in O(adancime).
+    std::vector<PasDrum> drumSpre(IndexNod tinta) const {
+        const IndexEntitati& idx = index();
+        std::vector<PasDrum> drum;
+        for (IndexNod copil = tinta, parinte = idx.parinte(tinta); parinte != NOD_NUL; copil = parinte, parinte = idx.parinte(parinte)) {
+            drum.push_back({parinte, noduri()[parinte].da == copil});
+        }
+        std::reverse(drum.begin(), drum.end());
+        return drum;
+    }
+
+    // Acces pentru parcurgeri din afara clasei (SesiuneJoc); arborele ramane read-only.
+    IndexNod radacina() const { return radacina_; }
+    const Nod& nod(IndexNod index) const { return noduri()[index]; }
+    std::string_view text(IndexNod index) const { return sir(noduri()[index].text); }
+
+    // Functia de ghicire: joaca pe raspunsurile din is si scrie transcrierea in iesire.
+    template <IesireText Iesire>
+    std::optional<Entitate> determinaEntitatea(std::istream& is, Iesire& iesire) const;
+    std::optional<Entitate> determinaEntitatea(std::istream& is, std::ostream& os) const;
+
+    int calculeazaAdancime() const {
+        std::size_t adancime = 0;
+        parcurge([&](IndexNod, const Nod&, std::size_t nivel) { adancime = std::max(adancime, nivel); });
+        return static_cast<int>(adancime);
+    }
+
+    // Toate statisticile dintr-o singura parcurgere liniara.
+    StatisticiArbore statistici() const {
+        StatisticiArbore s;
+        parcurge([&](IndexNod, const Nod& nod, std::size_t nivel) {
+            if (nivel > s.noduri_pe_nivel.size()) {
+                s.noduri_pe_nivel.resize(nivel, 0);
+                s.frunze_pe_nivel.resize(nivel, 0);
+            }
+            ++s.noduri;
+            ++s.noduri_pe_nivel[nivel - 1];
+            if (nod.esteFrunza()) {
+                ++s.frunze;
+                ++s.frunze_pe_nivel[nivel - 1];
+                s.suma_adancimi_frunze += nivel;
+            }
+        });
+        s.adancime = s.noduri_pe_nivel.size();
+        return s;
+    }
+    std::size_t numarNoduri() const { return noduri().size(); }
+    const std::string& getTema() const { return tema_; }
+    std::uint64_t generatie() const { return generatie_ ? *generatie_ : 0; }
+
+    friend std::ostream& operator<<(std::ostream& os, const ArboreAkinator& arbore) {
+        if (arbore.radacina_ != NOD_NUL) {
+            os << "Arbore curent (Adancime): " << arbore.calculeazaAdancime();
+        } else {
+            os << "Arbore curent: [Gol]";
+        }
+        return os;
+    }
+};
+
+// Arbori sintetici valizi (intrebari si nume unice) pentru masuratori la scara.
+// La fiecare nod intern, "da" primeste k din cele n entitati ale subarborelui:
+//  - echilibrat: k = n / 2 (adancime ~ log2 n);
+//  - lant: k = 1, adica o frunza pe fiecare nivel (adancime n);
+//  - aleator: fiecare entitate merge pe "da" cu probabilitatea asimetrie (0.5 = simetric).
+// Cu adancime_maxima > 0, k se restrange astfel incat ambele ramuri sa incapa.
+enum class FormaArbore : std::uint8_t { Echilibrat, Lant, Aleator };
+inline constexpr std::array<const char*, 3> NUME_FORME = {"echilibrat", "lant", "aleator"};
+
+inline std::optional<FormaArbore> formaDinNume(std::string_view nume) {
+    for (std::size_t i = 0; i < NUME_FORME.size(); ++i) {
+        if (nume == NUME_FORME[i]) return static_cast<FormaArbore>(i);
+    }
+    return std::nullopt;
+}
+
+struct ParametriGenerare {
+    FormaArbore forma = FormaArbore::Echilibrat;
+    std::size_t entitati = 1000;
+    double asimetrie = 0.5;
+    std::size_t adancime_maxima = 0;  // 0: fara limita
+    std::uint64_t samanta = 1;
+};
+
+class GeneratorArbore {
+private:
+    ParametriGenerare parametri_;
+    std::mt19937_64 generator_;
+    std::size_t adancime_ = 0;
+
+    // Cate entitati merg pe "da" dintr-un subarbore cu n >= 2 entitati si inca
+    // `ramase` niveluri disponibile (ramase == 0: fara limita).
+    std::size_t imparte(std::size_t n, std::size_t ramase) {
+        std::size_t k = 1;
+        switch (parametri_.forma) {
+            case FormaArbore::Echilibrat:
+                k = n / 2;
+                break;
+            case FormaArbore::Lant:
+                k = 1;
+                break;
+            case FormaArbore::Aleator:
+                k = 1 + std::binomial_distribution<std::size_t>(n - 2, parametri_.asimetrie)(generator_);
+                break;
+        }
+        if (ramase > 0) {
+            // Un subarbore cu r niveluri (noduri pe drum) are cel mult 2^(r-1) frunze.
+            const std::size_t capacitate = ramase - 2 >= 63 ? n : std::size_t{1} << (ramase - 2);
+            k = std::clamp(k, n > capacitate ? n - capacitate : std::size_t{1}, std::min(capacitate, n - 1));
+        }
+        return k;
+    }
+
+public:
+    explicit GeneratorArbore(const ParametriGenerare& parametri) :
+        parametri_(parametri), generator_(parametri.samanta) {}
+
+    std::size_t adancime() const { return adancime_; }
+
+    // Fara recursie; nodurile se aloca in preordine ("da" inaintea lui "nu"), ca la incarcare.
+    ArboreAkinator genereaza(const std::string& tema) {
+        const std::size_t n = parametri_.entitati;
+        const std::size_t limita = parametri_.adancime_maxima;
+        if (n == 0 || n >= NOD_NUL / 2) {
+            throw std::runtime_error("Numarul de entitati trebuie sa fie intre 1 si " + std::to_string(NOD_NUL / 2 - 1) + ".");
+        }
+        if (limita > 0 && limita <= 64 && n > (std::size_t{1} << (limita - 1))) {
+            throw std::runtime_error(std::to_string(n) + " entitati nu incap intr-un arbore de adancime " + std::to_string(limita) + ".");
+        }
+        if (!(parametri_.asimetrie > 0.0 && parametri_.asimetrie < 1.0)) {
+            throw std::runtime_error("Asimetria trebuie sa fie in intervalul (0, 1).");
+        }
+
+        ArboreAkinator nou(tema);
+        nou.noduri_.reserve(2 * n - 1);
+        nou.entitati_.reserve(n);
+        auto tabela = nou.tabelaNoua();
+        const SirPool domeniu = nou.interneaza("sintetic", tabela);
+        const SirPool tip = nou.interneaza("generat", tabela);
+
+        struct Cadru {
+            std::size_t entitati;
+            std::size_t nivel;
+            IndexNod parinte;
+            bool da;
+        };
+        std::vector<Cadru> stiva{{n, 1, NOD_NUL, false}};
+        std::size_t intrebari = 0;
+        std::string text;
+        adancime_ = 0;
+
+        while (!stiva.empty()) {
+            const Cadru c = stiva.back();
+            stiva.pop_back();
+            adancime_ = std::max(adancime_, c.nivel);
+
+            IndexNod index;
+            if (c.entitati == 1) {
+                text = "Entitatea " + std::to_string(nou.entitati_.size() + 1);
+                Nod frunza;
+                frunza.text = nou.adaugaSir(text);
+                frunza.entitate = static_cast<std::uint32_t>(nou.entitati_.size());
+                nou.entitati_.push_back({domeniu, tip});
+                index = nou.adaugaNod(frunza);
+            } else {
+                text = "Are proprietatea " + std::to_string(++intrebari) + "?";
+                Nod intern;
+                intern.text = nou.adaugaSir(text);
+                index = nou.adaugaNod(intern);
+                const std::size_t k = imparte(c.entitati, limita > 0 ? limita - c.nivel + 1 : 0);
+                stiva.push_back({c.entitati - k, c.nivel + 1, index, false});
+                stiva.push_back({k, c.nivel + 1, index, true});
+            }
+
+            if (c.parinte == NOD_NUL) {
+                nou.radacina_ = index;
+            } else if (c.da) {
+                nou.noduri_[c.parinte].da = index;
+            } else {
+                nou.noduri_[c.parinte].nu = index;
+            }
+        }
+        nou.pool_.shrink_to_fit();
+        nou.generatie_ = urmatoareaGeneratie();
+        nou.indexeaza();
+        return nou;
+    }
+};
+
+// Starea unui joc ca obiect explicit: nodul curent si drumul parcurs pana la el.
+// Avanseaza cate un raspuns pe apel si doar citeste arborele, deci oricate sesiuni
+// pot rula in paralel pe acelasi snapshot fara niciun lock.
+class SesiuneJoc {
+public:
+    enum class Stare : std::uint8_t { Intrebare, Ghicire, Ghicit, Negasit };
+
+private:
+    std::shared_ptr<const ArboreAkinator> pastrat_;  // tine snapshot-ul in viata, daca e partajat
+    const ArboreAkinator* arbore_;
+    IndexNod curent_ = NOD_NUL;
+    Stare stare_ = Stare::Negasit;
+
+    // Istoricul e doar sirul de raspunsuri, cate un bit pe pas (1 = da); nodurile se
+    // refac pornind din radacina. Primii 64 de pasi nu aloca nimic.
+    std::uint64_t raspunsuri_ = 0;
+    std::vector<std::uint64_t> raspunsuri_extra_;
+    std::uint32_t pasi_ = 0;
+
+    void inregistreaza(bool da) {
+        const std::uint32_t cuvant = pasi_ / 64;
+        const std::uint64_t bit = std::uint64_t{da} << (pasi_ % 64);
+        if (cuvant == 0) {
+            raspunsuri_ |= bit;
+        } else {
+            if (raspunsuri_extra_.size() < cuvant) raspunsuri_extra_.push_back(0);
+            raspunsuri_extra_[cuvant - 1] |= bit;
+        }
+        ++pasi_;
+    }
+
+    void mutaLa(IndexNod nod) {
+        curent_ = nod;
+        if (nod == NOD_NUL) {
+            stare_ = Stare::Negasit;
+        } else {
+            stare_ = arbore_->nod(nod).esteFrunza() ? Stare::Ghicire : Stare::Intrebare;
+            Metrici::vizita(arbore_->generatie(), nod, arbore_->numarNoduri());
+        }
+    }
+
+public:
+    explicit SesiuneJoc(const ArboreAkinator& arbore) : arbore_(&arbore) {
+        mutaLa(arbore.radacina());
+    }
+
+    explicit SesiuneJoc(std::shared_ptr<const ArboreAkinator> arbore) :
+        pastrat_(std::move(arbore)), arbore_(pastrat_.get()) {
+        mutaLa(arbore_->radacina());
+    }
+
+    Stare stare() const { return stare_; }
+    bool terminata() const { return stare_ == Stare::Ghicit || stare_ == Stare::Negasit; }
+    IndexNod nodCurent() const { return curent_; }
+    std::size_t numarPasi() const { return pasi_; }
+
+    bool raspunsLaPasul(std::size_t pas) const {
+        const std::uint64_t cuvant = pas < 64 ? raspunsuri_ : raspunsuri_extra_[pas / 64 - 1];
+        return (cuvant >> (pas % 64)) & 1U;
+    }
+
+    // Raspunsurile date, ca 'd'/'n'; identifica frunza pentru ArboreAkinator::nodLaCale.
+    std::string cale() const {
+        std::string rezultat(pasi_, 'n');
+        for (std::size_t pas = 0; pas < pasi_; ++pas) {
+            if (raspunsLaPasul(pas)) rezultat[pas] = 'd';
+        }
+        return rezultat;
+    }
+
+    // Jocul s-a terminat cu o propunere respinsa (nu intr-o ramura goala).
+    bool aGresit() const { return stare_ == Stare::Negasit && curent_ != NOD_NUL; }
+
+    const ArboreAkinator& arbore() const { return *arbore_; }
+
+    std::string_view intrebare() const { return arbore_->text(curent_); }
+    Entitate propunere() const { return arbore_->entitate(curent_); }
+
+    // Intoarce false doar pentru un raspuns invalid la o intrebare; starea ramane aceeasi.
+    // La propunerea finala orice raspuns in afara de "da" inseamna ca nu am ghicit.
+    bool raspunde(std::string_view raspuns) {
+        if (stare_ == Stare::Ghicire) {
+            stare_ = raspuns == "da" ? Stare::Ghicit : Stare::Negasit;
+            if (stare_ == Stare::Negasit) Metrici::ghicireGresita(arbore_->generatie(), curent_, arbore_->numarNoduri());
+            return true;
+        }
+        if (stare_ != Stare::Intrebare) return true;
+
+        const Nod& nod = arbore_->nod(curent_);
+        if (raspuns == "da" || raspuns == "nu") {
+            const bool da = raspuns == "da";
+            Metrici::raspuns(arbore_->generatie(), curent_, arbore_->numarNoduri(), da);
+            inregistreaza(da);
+            mutaLa(da ? nod.da : nod.nu);
+        } else {
+            Metrici::raspunsInvalid(arbore_->generatie(), curent_, arbore_->numarNoduri());
+            return false;
+        }
+        return true;
+    }
+};
+
+// Raspunsul jucatorului la o intrebare sau la o propunere. Lipsa: intrarea s-a terminat
+// inainte de raspuns; Invalid apare doar la intrebari (la propunere orice alt raspuns
+// decat "da" e un "nu").
+enum class RaspunsJucator : std::uint8_t { Da, Nu, Invalid, Lipsa };
+
+// Litera fiecarui RaspunsJucator in jurnalul de evenimente (--lot ... --evenimente).
+inline constexpr std::string_view LITERE_RASPUNS = "dni-";
+
+struct EvenimentJoc {
+    IndexNod nod;                // intrebarea sau propunerea la care s-a raspuns
+    RaspunsJucator raspuns;
+    std::uint64_t ns;            // de la inceputul jocului; 0 daca jocul nu e cronometrat
+};
+
+// Un joc citit dintr-un flux, pastrat ca evenimente compacte. Textul jocului se scrie in
+// iesire pe masura ce se inregistreaza evenimentele: intrebarea (sau propunerea) inainte
+// sa se citeasca raspunsul, mesajul de eroare imediat dupa. Un std::ostream legat de
+// fluxul de intrare (tie()) se goleste inainte de fiecare citire, deci jocul interactiv
+// vede intrebarea la timp; IesireStdout ramane in bufferul ei pana se umple sau pana la
+// goleste(). Cu IesireNula nu se formateaza nimic. Obiectul se refoloseste intre jocuri:
+// dupa primele jocuri nu mai aloca.
+class TranscriereJoc {
+private:
+    std::vector<EvenimentJoc> evenimente_;
+    std::optional<SesiuneJoc> sesiune_;
+    std::string raspuns_;
+
+    template <IesireText Iesire>
+    static void scrieInainte(const ArboreAkinator& arbore, IndexNod nod, Iesire& iesire) {
+        const std::string_view text = arbore.text(nod);
+        if (arbore.nod(nod).esteFrunza()) {
+            iesire.append("M-am gandit la: ");
+            iesire.append(text);
+            iesire.append(". E corect (da/nu)?\n");
+        } else {
+            iesire.append("Intrebare: ");
+            iesire.append(text);
+            iesire.append(" (da/nu)?\n");
+        }
+    }
+
+    template <IesireText Iesire>
+    static void scrieDupa(const ArboreAkinator& arbore, const EvenimentJoc& e, Iesire& iesire) {
+        const bool frunza = arbore.nod(e.nod).esteFrunza();
+        if (e.raspuns == RaspunsJucator::Invalid && !frunza) iesire.append("Raspuns invalid. Incearca 'da' sau 'nu'.\n");
+        if (e.raspuns == RaspunsJucator::Lipsa) {
+            iesire.append(frunza ? "Eroare la citirea raspunsului final din fisier.\n" : "Eroare la citirea raspunsului din fisier.\n");
+        }
+    }
+
+public:
+    std::span<const EvenimentJoc> evenimente() const { return evenimente_; }
+    // Sesiunea ultimului joc (de ex. aGresit() si cale() pentru invatare); citeste arborele
+    // primit de joaca(), deci e valida cat timp acesta exista.
+    const SesiuneJoc& sesiune() const { return *sesiune_; }
+
+    // Cu masura, timpul petrecut in scriere se numara la FazaTimp::Iesire.
+    template <IesireText Iesire>
+    std::optional<Entitate> joaca(const ArboreAkinator& arbore, std::istream& is, bool cronometrat,
+                                  Iesire& iesire, MasuraJoc* masura = nullptr) {
+        const auto start = cronometrat ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+        auto inainte = [&](IndexNod nod) {
+            if constexpr (!std::is_same_v<Iesire, IesireNula>) {
+                const Cronometru scriere = masura ? masura->iesire() : Cronometru(false);
+                scrieInainte(arbore, nod, iesire);
+                if (masura) masura->adaugaIesire(scriere);
+            }
+        };
+        auto adauga = [&](IndexNod nod, RaspunsJucator raspuns) {
+            const std::uint64_t ns = cronometrat
+                ? static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start).count())
+                : 0;
+            evenimente_.push_back({nod, raspuns, ns});
+            if constexpr (!std::is_same_v<Iesire, IesireNula>) {
+                if (raspuns != RaspunsJucator::Invalid && raspuns != RaspunsJucator::Lipsa) return;
+                const Cronometru scriere = masura ? masura->iesire() : Cronometru(false);
+                scrieDupa(arbore, evenimente_.back(), iesire);
+                if (masura) masura->adaugaIesire(scriere);
+            }
+        };
+
+        evenimente_.clear();
+        SesiuneJoc& sesiune = sesiune_.emplace(arbore);
+        while (sesiune.stare() == SesiuneJoc::Stare::Intrebare) {
+            const IndexNod nod = sesiune.nodCurent();
+            inainte(nod);
+            if (!(is >> raspuns_)) {
+                adauga(nod, RaspunsJucator::Lipsa);
+                return std::nullopt;
+            }
+            if (!sesiune.raspunde(raspuns_)) {
+                adauga(nod, RaspunsJucator::Invalid);
+            } else {
+                adauga(nod, raspuns_ == "da" ? RaspunsJucator::Da : RaspunsJucator::Nu);
+            }
+        }
+
+        if (sesiune.stare() == SesiuneJoc::Stare::Ghicire) {
+            const IndexNod nod = sesiune.nodCurent();
+            inainte(nod);
+            if (!(is >> raspuns_)) {
+                adauga(nod, RaspunsJucator::Lipsa);
+                return std::nullopt;
+            }
+            sesiune.raspunde(raspuns_);
+            const bool ghicit = sesiune.stare() == SesiuneJoc::Stare::Ghicit;
+            adauga(nod, ghicit ? RaspunsJucator::Da : RaspunsJucator::Nu);
+            if (ghicit) return sesiune.propunere();
+        }
+        return std::nullopt;
+    }
+
+    // Reface din evenimente (ale unui joc pe acelasi arbore) textul scris de joaca():
+    // intrebarile, propunerea si mesajele de eroare, fara rezultatul final.
+    template <IesireText Iesire>
+    static void randeaza(const ArboreAkinator& arbore, std::span<const EvenimentJoc> evenimente, Iesire& iesire) {
+        for (const EvenimentJoc& e : evenimente) {
+            scrieInainte(arbore, e.nod, iesire);
+            scrieDupa(arbore, e, iesire);
+        }
+    }
+};
+
+template <IesireText Iesire>
+std::optional<Entitate> ArboreAkinator::determinaEntitatea(std::istream& is, Iesire& iesire) const {
+    thread_local TranscriereJoc transcriere;
+    MasuraJoc masura;
+    return transcriere.joaca(*this, is, masura.activ(), iesire, &masura);
+}
+
+inline std::optional<Entitate> ArboreAkinator::determinaEntitatea(std::istream& is, std::ostream& os) const {
+    IesireFlux iesire(os);
+    const std::optional<Entitate> rezultat = determinaEntitatea(is, iesire);
+    aDouaBibliotecaExterna(os, getTema());
+    return rezultat;
+}
+
+// -----------------------------------------------------------
+// 4. MANAGER RASPUNSURI (REPOZITORIU)
+// -----------------------------------------------------------
+
+// Versiunea publicata a unei teme. Arborele este imutabil dupa publicare, deci
+// poate fi impartit intre oricate jocuri; orice schimbare (reincarcare sau lectie)
+// construieste o copie, o modifica si o publica sub mutex, iar jocurile in
+// desfasurare raman pe snapshot-ul vechi prin shared_ptr. Cititorii iau doar mutex_,
+// cat sa copieze pointerul; scriitorii se serializeaza intre ei pe mutex_scriere_.
+//
+// Lectiile se adauga intr-un jurnal append-only langa fisierul temei
+// (<tema>_arbore.jurnal), reaplicat dupa fiecare incarcare a fisierului de baza.
+// checkpoint() muta lectiile din jurnal in fisierul de baza.
+class SlotTema {
+private:
+    mutable std::mutex mutex_;
+    std::mutex mutex_scriere_;
+    std::mutex mutex_checkpoint_;
+    std::shared_ptr<const ArboreAkinator> arbore_;
+    std::filesystem::file_time_type modificat_{};
+    bool din_binar_ = false;            // fisierul de baza incarcat e .akb
+    std::uintmax_t octeti_jurnal_ = 0;  // cat din jurnal e deja in arbore_
+    // Fisierul jurnal la care se refera octeti_jurnal_. Compactarea il inlocuieste, deci
+    // daca altul a compactat, offset-ul nu mai spune nimic si tema se reincarca.
+    std::pair<std::uintmax_t, std::uintmax_t> identitate_jurnal_{};
+    std::string tema_;
+    std::string fisier_;
+    std::string jurnal_;
+    std::once_flag prima_incarcare_;
+    std::atomic<bool> incarcata_{false};
+
+    struct LectieInAsteptare {
+        const Lectie* lectie;
+        bool gata = false;             // protejat de mutex_lectii_
+        std::exception_ptr eroare;     // scrisa de lot inainte de gata
+    };
+    std::mutex mutex_lectii_;
+    std::condition_variable cv_lectii_;
+    std::vector<LectieInAsteptare*> lectii_in_asteptare_;  // protejat de mutex_lectii_
+    bool lot_in_lucru_ = false;                            // protejat de mutex_lectii_
+
+    void publica(std::shared_ptr<const ArboreAkinator> nou) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        arbore_ = std::move(nou);
+    }
+
+    std::shared_ptr<const ArboreAkinator> publicat() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return arbore_;
+    }
+
+    // (dispozitiv, inode) pe POSIX, {0, 0} daca jurnalul lipseste; pe celelalte platforme
+    // jurnalul nu se imparte intre procese, deci ajunge ca toate sa fie la fel.
+    std::pair<std::uintmax_t, std::uintmax_t> identitateJurnal() const {
+#if AKINATOR_POSIX
+        struct stat st {};
+        if (::stat(jurnal_.c_str(), &st) == 0) return {st.st_dev, st.st_ino};
+#endif
+        return {0, 0};
+    }
+
+    std::string caleBinar() const { return std::filesystem::path(fisier_).replace_extension(".akb").string(); }
+
+    // O lectie e deja in arbore daca drumul ei duce la intrebarea ei: o lectie transforma
+    // frunza in intrebare, iar lectiile de dupa ea nu mai schimba nodul acela. Se intampla
+    // cand fisierul de baza a fost salvat, dar jurnalul inca nu a fost compactat (alt
+    // proces e intre cei doi pasi sau a cazut intre ei).
+    static bool dejaInclusa(const ArboreAkinator& arbore, IndexNod nod, const Lectie& lectie) {
+        return nod != NOD_NUL && !arbore.nod(nod).esteFrunza() && arbore.text(nod) == lectie.intrebare;
+    }
+
+    // Aplica liniile complete ale jurnalului incepand de la octetul de_la si
+    // intoarce offset-ul de dupa ultima linie aplicata. Indexul se reface o singura data.
+    std::uintmax_t aplicaJurnal(ArboreAkinator& arbore, std::uintmax_t de_la) const {
+        std::ifstream f(jurnal_, std::ios::binary);
+        if (!f.is_open()) return 0;
+        f.seekg(static_cast<std::streamoff>(de_la));
+
+        std::string linie;
+        std::uintmax_t pozitie = de_la;
+        bool schimbat = false;
+        while (std::getline(f, linie)) {
+            if (f.eof()) break;  // linie fara '\n': inca se scrie
+            pozitie += linie.size() + 1;
+            if (linie.empty()) continue;
+            try {
+                const Lectie lectie = lectieDinJSON(linie);
+                const IndexNod nod = arbore.nodLaCale(lectie.cale);
+                if (dejaInclusa(arbore, nod, lectie)) continue;
+                arbore.invata(nod, lectie);
+                schimbat = true;
+            } catch (const std::runtime_error& e) {
+                std::cerr << "Atentie: " << jurnal_ << " la octetul " << (pozitie - linie.size() - 1)
+                          << " ignorat: " << e.what() << std::endl;
+            }
+        }
+        if (schimbat) arbore.indexeaza();
+        return pozitie;
+    }
+
+public:
+    SlotTema(std::string tema, std::string fisier) :
+        arbore_(std::make_shared<const ArboreAkinator>(tema)),
+        tema_(std::move(tema)),
+        fisier_(std::move(fisier)),
+        jurnal_(std::filesystem::path(fisier_).replace_extension(".jurnal").string()) {}
+
+    // Prima incarcare se face o singura data, pe firul care ajunge primul (un incarcator
+    // al registrului sau primul joc al temei); ceilalti asteapta doar dupa tema aceasta.
+    void incarcaPrimaData() {
+        std::call_once(prima_incarcare_, [this] {
+            try {
+                reimprospateaza();
+            } catch (const std::runtime_error& e) {
+                std::cerr << "Atentie: " << e.what() << std::endl;
+            }
+            incarcata_.store(true, std::memory_order_release);
+        });
+    }
+
+    bool incarcata() const { return incarcata_.load(std::memory_order_acquire); }
+
+    std::shared_ptr<const ArboreAkinator> snapshot() {
+        if (!incarcata()) incarcaPrimaData();
+        return publicat();
+    }
+
+    // Reincarca fisierul doar daca s-a schimbat pe disc de la ultima publicare.
+    // Parsarea se face in afara mutex-ului; cititorii nu asteapta dupa ea.
+    // Un .akb generat din JSON si cel putin la fel de nou decat acesta are prioritate.
+    // Daca doar jurnalul a crescut (alt proces a invatat ceva), se aplica doar coada lui.
+    bool reimprospateaza() {
+        std::lock_guard<std::mutex> scriere(mutex_scriere_);
+        return reimprospateazaBlocat();
+    }
+
+private:
+    // Apelat cu mutex_scriere_ luat.
+    bool reimprospateazaBlocat() {
+        std::error_code ec_json;
+        std::error_code ec_binar;
+        std::error_code ec_jurnal;
+        const std::string binar = caleBinar();
+        const auto modificat_json = std::filesystem::last_write_time(fisier_, ec_json);
+        const auto modificat_binar = std::filesystem::last_write_time(binar, ec_binar);
+        const bool foloseste_binar = !ec_binar && (ec_json || modificat_binar >= modificat_json);
+        if (ec_json && !foloseste_binar) return false;
+
+        const auto modificat = foloseste_binar ? modificat_binar : modificat_json;
+        // Un jurnal aparut de la zero nu e compactat: offset-ul 0 e valabil si pentru el.
+        const auto identitate = identitateJurnal();
+        const bool compactat = identitate_jurnal_ != std::pair<std::uintmax_t, std::uintmax_t>{} && identitate != identitate_jurnal_;
+        if (modificat == modificat_ && !compactat) {
+            const std::uintmax_t lungime_jurnal = std::filesystem::file_size(jurnal_, ec_jurnal);
+            if (ec_jurnal || lungime_jurnal <= octeti_jurnal_) return false;
+            auto nou = std::make_shared<ArboreAkinator>(*publicat());
+            octeti_jurnal_ = aplicaJurnal(*nou, octeti_jurnal_);
+            identitate_jurnal_ = identitate;
+            publica(std::move(nou));
+            return true;
+        }
+
+        const Cronometru cronometru(true);
+        auto nou = std::make_shared<ArboreAkinator>(tema_);
+        bool din_binar = foloseste_binar;
+        if (foloseste_binar) {
+            try {
+                nou->incarcaDinFisierBinar(binar);
+            } catch (const std::runtime_error& e) {
+                if (ec_json) throw;
+                std::cerr << "Atentie: " << e.what() << "; se foloseste " << fisier_ << std::endl;
+                nou->incarcaDinFisier(fisier_);
+                din_binar = false;
+            }
+        } else {
+            nou->incarcaDinFisier(fisier_);
+        }
+        octeti_jurnal_ = aplicaJurnal(*nou, 0);
+        identitate_jurnal_ = identitate;
+        cronometru.inregistreaza(FazaTimp::Incarcare);
+
+        publica(std::move(nou));
+        modificat_ = modificat;
+        din_binar_ = din_binar;
+        return true;
+    }
+
+public:
+    // Copy-on-write pe loturi: cat timp un fir aplica un lot, lectiile noi se aduna, iar
+    // urmatorul lot le aplica pe toate pe aceeasi copie (liniara, fara alocari per nod),
+    // cu o singura reindexare si o singura scriere in jurnal. Jurnalul ramane blocat de la
+    // citirea cozii lui pana la publicare, deci octeti_jurnal_ ajunge exact dupa liniile
+    // noastre si reimprospateaza() nu le mai aplica inca o data.
+    void invata(const Lectie& lectie) {
+        incarcaPrimaData();
+        LectieInAsteptare asteptare{&lectie, false, nullptr};
+        std::unique_lock<std::mutex> lock(mutex_lectii_);
+        lectii_in_asteptare_.push_back(&asteptare);
+        while (!asteptare.gata) {
+            if (lot_in_lucru_) {
+                cv_lectii_.wait(lock);
+                continue;
+            }
+            std::vector<LectieInAsteptare*> lot;
+            lot.swap(lectii_in_asteptare_);
+            lot_in_lucru_ = true;
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> scriere(mutex_scriere_);
+                aplicaLot(lot);
+            }
+            lock.lock();
+            for (LectieInAsteptare* l : lot) l->gata = true;
+            lot_in_lucru_ = false;
+            cv_lectii_.notify_all();
+        }
+        if (asteptare.eroare) std::rethrow_exception(asteptare.eroare);
+    }
+
+private:
+    // Apelat cu mutex_scriere_ luat; erorile raman in lot, nu se arunca.
+    void aplicaLot(const std::vector<LectieInAsteptare*>& lot) {
+        try {
+            JurnalBlocat jurnal(jurnal_);
+            // Lectiile altor procese (sau checkpoint-ul lor) ajung in snapshot inaintea lotului.
+            reimprospateazaBlocat();
+            auto nou = std::make_shared<ArboreAkinator>(*publicat());
+            const std::uintmax_t lungime = jurnal.lungime();
+
+            std::string linii;
+            if (octeti_jurnal_ < lungime) linii += '\n';  // linie neterminata lasata de un proces cazut
+            const std::size_t inceput_linii = linii.size();
+            for (std::size_t i = 0; i < lot.size(); ++i) {
+                const Lectie& lectie = *lot[i]->lectie;
+                const IndexNod frunza = nou->nodLaCale(lectie.cale);
+                if (frunza == NOD_NUL || !nou->nod(frunza).esteFrunza()) {
+                    lot[i]->eroare = std::make_exception_ptr(std::runtime_error(
+                        "Drumul '" + lectie.cale + "' nu duce la o entitate in tema " + tema_ + "."));
+                    continue;
+                }
+                nou->invata(frunza, lectie);
+                linii.append(lectieCaJSON(lectie)).append(1, '\n');
+            }
+
+            if (linii.size() > inceput_linii) {
+                nou->indexeaza();
+                jurnal.adauga(linii);
+                octeti_jurnal_ = lungime + linii.size();
+                identitate_jurnal_ = identitateJurnal();
+                publica(std::move(nou));
+            }
+        } catch (...) {
+            // Nimic nu s-a publicat: toate lectiile lotului primesc eroarea.
+            for (LectieInAsteptare* l : lot) l->eroare = std::current_exception();
+        }
+    }
+
+public:
+    // Scrie versiunea publicata peste fisierul de baza (ambele formate in flux, printr-un
+    // fisier temporar redenumit la final), apoi scoate din jurnal lectiile incluse. O tema
+    // incarcata din .akb isi rescrie si JSON-ul, daca il are, ca lectiile sa nu ramana doar
+    // in .akb (JSON-ul intai, ca .akb-ul sa ramana cel mai nou). Se scrie un snapshot
+    // imutabil fara mutex_scriere_, deci nici jocurile, nici lectiile noi nu asteapta dupa
+    // scriere; lectiile invatate intre timp raman in jurnal. Intoarce false daca jurnalul
+    // nu avea nimic de mutat.
+    bool checkpoint() {
+        std::lock_guard<std::mutex> unul(mutex_checkpoint_);
+        // Si intre procese: doua checkpoint-uri simultane ar rescrie acelasi fisier de baza
+        // si ar compacta jurnalul cu offset-uri diferite. Fisierul de blocare e gol si nu
+        // se inlocuieste niciodata, deci ajunge acelasi mecanism ca la jurnal. Nici nu se
+        // sterge: un proces care asteapta ar bloca apoi alt fisier decat urmatorul venit.
+        JurnalBlocat blocare(std::filesystem::path(fisier_).replace_extension(".blocare").string());
+        incarcaPrimaData();
+        reimprospateaza();  // si lectiile (sau checkpoint-ul) scrise intre timp de alte procese
+
+        std::shared_ptr<const ArboreAkinator> curent;
+        std::uintmax_t inclus = 0;
+        bool binar = false;
+        {
+            std::lock_guard<std::mutex> scriere(mutex_scriere_);
+            curent = publicat();
+            inclus = octeti_jurnal_;
+            binar = din_binar_;
+        }
+        if (inclus == 0 || curent->numarNoduri() == 0) return false;
+
+        const std::string tinta = binar ? caleBinar() : fisier_;
+        std::error_code ec_json;
+        if (!binar || std::filesystem::exists(fisier_, ec_json)) {
+            curent->salveazaJSON(fisier_);
+        }
+        if (binar) {
+            curent->salveazaBinar(tinta);
+        }
+
+        // Din acest punct fisierul de baza contine lectiile; daca urmatorii pasi nu se mai
+        // fac, la reincarcare dejaInclusa() le sare.
+        std::lock_guard<std::mutex> scriere(mutex_scriere_);
+        JurnalBlocat jurnal(jurnal_);
+        jurnal.pastreazaDeLa(inclus);
+        octeti_jurnal_ -= inclus;
+        identitate_jurnal_ = identitateJurnal();
+        std::error_code ec;
+        const auto modificat = std::filesystem::last_write_time(tinta, ec);
+        if (!ec) modificat_ = modificat;  // snapshot-ul publicat e deja la zi
+        return true;
+    }
+};
+
+// Temele unui director: fiecare <tema>_arbore.json (sau doar .akb) devine un SlotTema.
+// Registrul e partajat de toti managerii care folosesc acelasi director, deci fiecare
+// fisier se parseaza o singura data pe proces. Cu ModIncarcare::Paralel, temele incep
+// sa se incarce imediat, pe cel mult hardware_concurrency() fire; cu LaCerere, o tema se
+// incarca abia la prima selectare. In ambele cazuri un joc asteapta doar tema lui.
+enum class ModIncarcare : std::uint8_t { Paralel, LaCerere };
+
+class RegistruTeme {
+private:
+    std::map<std::string, std::shared_ptr<SlotTema>> teme_;
+    std::vector<SlotTema*> de_incarcat_;
+    std::atomic<std::size_t> urmatoarea_{0};
+    std::atomic<bool> oprire_{false};
+    std::vector<std::thread> incarcatori_;
+
+public:
+    RegistruTeme(const std::filesystem::path& director, ModIncarcare mod) {
+        for (const std::string& tema : scaneaza(director)) {
+            const std::string fisier = (director / (tema + "_arbore.json")).string();
+            teme_.emplace(tema, std::make_shared<SlotTema>(tema, fisier));
+        }
+        if (mod == ModIncarcare::LaCerere || teme_.empty()) return;
+
+        for (const auto& pair : teme_) de_incarcat_.push_back(pair.second.get());
+        const std::size_t fire = std::min<std::size_t>(de_incarcat_.size(), std::max(1U, std::thread::hardware_concurrency()));
+        for (std::size_t i = 0; i < fire; ++i) {
+            incarcatori_.emplace_back([this] {
+                for (std::size_t t; !oprire_.load(std::memory_order_relaxed) && (t = urmatoarea_.fetch_add(1)) < de_incarcat_.size();) {
+                    de_incarcat_[t]->incarcaPrimaData();
+                }
+            });
+        }
+    }
+
+    // La distrugere se asteapta doar temele aflate deja in incarcare.
+    ~RegistruTeme() {
+        oprire_.store(true, std::memory_order_relaxed);
+        for (std::thread& fir : incarcatori_) fir.join();
+    }
+
+    RegistruTeme(const RegistruTeme&) = delete;
+    RegistruTeme& operator=(const RegistruTeme&) = delete;
+
+    const std::map<std::string, std::shared_ptr<SlotTema>>& teme() const { return teme_; }
+
+    // Numele temelor din director, sortate: <tema>_arbore.json sau <tema>_arbore.akb.
+    static std::vector<std::string> scaneaza(const std::filesystem::path& director) {
+        std::vector<std::string> teme;
+        std::error_code ec;
+        for (const auto& intrare : std::filesystem::directory_iterator(director.empty() ? "." : director, ec)) {
+            const std::filesystem::path& cale = intrare.path();
+            if (cale.extension() != ".json" && cale.extension() != ".akb") continue;
+            const std::string nume = cale.stem().string();
+            constexpr std::string_view SUFIX = "_arbore";
+            if (nume.size() <= SUFIX.size() || !nume.ends_with(SUFIX)) continue;
+            teme.push_back(nume.substr(0, nume.size() - SUFIX.size()));
+        }
+        std::sort(teme.begin(), teme.end());
+        teme.erase(std::unique(teme.begin(), teme.end()), teme.end());
+        return teme;
+    }
+
+    // Registrul directorului, creat la prima cerere si refolosit cat timp il tine
+    // cineva in viata; modul conteaza doar pentru cel care il creeaza.
+    static std::shared_ptr<RegistruTeme> pentru(const std::filesystem::path& director, ModIncarcare mod) {
+        static std::mutex mutex;
+        static std::map<std::string, std::weak_ptr<RegistruTeme>> registre;
+        std::error_code ec;
+        const std::string cheie = std::filesystem::weakly_canonical(director.empty() ? "." : director, ec).string();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::weak_ptr<RegistruTeme>& slab = registre[cheie];
+        if (auto existent = slab.lock()) return existent;
+        auto nou = std::make_shared<RegistruTeme>(director, mod);
+        slab = nou;
+        return nou;
+    }
+};
+
+class ManagerRaspunsuri {
+private:
+    // Sloturile sunt partajate intre copiile managerului: o tema se incarca o
+    // singura data si toate copiile vad aceeasi versiune publicata.
+    std::shared_ptr<RegistruTeme> registru_;
+    std::map<std::string, std::shared_ptr<SlotTema>> teme_; // Membru privat
+    std::shared_ptr<const ArboreAkinator> arbore_curent_;
+
+public:
+    // Temele din directorul curent; fiecare se incarca la prima selectare.
+    ManagerRaspunsuri() : ManagerRaspunsuri(RegistruTeme::pentru({}, ModIncarcare::LaCerere)) {}
+
+    explicit ManagerRaspunsuri(std::shared_ptr<RegistruTeme> registru) :
+        registru_(std::move(registru)),
+        teme_(registru_->teme()) {}
+
+    // R3: DESTRUCTOR
+    ~ManagerRaspunsuri() = default;
+
+    // R3: CONSTRUCTOR DE COPIERE (O(1) pe tema: se copiaza doar pointeri partajati)
+    ManagerRaspunsuri(const ManagerRaspunsuri& other) :
+        registru_(other.registru_),
+        teme_(other.teme_),
+        arbore_curent_(other.arbore_curent_)
+    {
+        primaBibliotecaExterna();
+    }
+
+    // R3: OPERATOR DE ATRIBUIRE
+    ManagerRaspunsuri& operator=(ManagerRaspunsuri other) {
+        std::swap(registru_, other.registru_);
+        std::swap(teme_, other.teme_);
+        std::swap(arbore_curent_, other.arbore_curent_);
+        return *this;
+    }
+
+    // Deplasare
+    ManagerRaspunsuri(ManagerRaspunsuri&& other) noexcept = default;
+    ManagerRaspunsuri& operator=(ManagerRaspunsuri&& other) noexcept = default;
+
+    // Publica snapshot-uri noi pentru temele ale caror fisiere s-au modificat. Temele
+    // inca neincarcate raman asa; le incarca prima selectare.
+    void reimprospateazaTeme() {
+        for (auto& pair : teme_) {
+            if (!pair.second->incarcata()) continue;
+            try {
+                pair.second->reimprospateaza();
+            } catch (const std::runtime_error& e) {
+                 std::cerr << "Atentie: " << e.what() << std::endl;
+            }
+        }
+    }
+
+    // Muta in fisierele de baza lectiile din jurnalele temelor incarcate (vezi
+    // SlotTema::checkpoint); intoarce cate teme s-au salvat.
+    std::size_t checkpoint() {
+        std::size_t salvate = 0;
+        for (auto& pair : teme_) {
+            if (!pair.second->incarcata()) continue;
+            try {
+                if (pair.second->checkpoint()) ++salvate;
+            } catch (const std::runtime_error& e) {
+                std::cerr << "Atentie: checkpoint " << pair.first << ": " << e.what() << std::endl;
+            }
+        }
+        return salvate;
+    }
+
+    // La fel, pentru o singura tema (incarcata la nevoie); erorile ajung la apelant.
+    bool checkpoint(const std::string& tema) {
+        auto it = teme_.find(tema);
+        if (it == teme_.end()) {
+            throw std::runtime_error("Tema nu exista.");
+        }
+        return it->second->checkpoint();
+    }
+
+    // Invata o entitate noua in tema data; jocurile care incep dupa aceea o vad.
+    void invata(const std::string& tema, const Lectie& lectie) {
+        auto it = teme_.find(tema);
+        if (it == teme_.end()) {
+            throw std::runtime_error("Tema nu exista.");
+        }
+        it->second->invata(lectie);
+    }
+
+    // O(1): nu copiaza si nu reciteste arborele, doar preia snapshot-ul publicat.
+    void selecteazaTema(const std::string& tema) {
+        const Cronometru cronometru(Metrici::esantion(FazaTimp::Selectare));
+        auto it = teme_.find(tema);
+        if (it == teme_.end()) {
+            throw std::runtime_error("Tema nu exista.");
+        }
+        arbore_curent_ = it->second->snapshot();
+        cronometru.inregistreaza(FazaTimp::Selectare);
+    }
+
+    const ArboreAkinator* getArboreCurent() const { return arbore_curent_.get(); }
+    std::shared_ptr<const ArboreAkinator> getSnapshotCurent() const { return arbore_curent_; }
+
+    // Versiunea publicata a fiecarei teme deja incarcate, in ordinea numelor.
+    std::vector<std::shared_ptr<const ArboreAkinator>> snapshoturi() const {
+        std::vector<std::shared_ptr<const ArboreAkinator>> rezultat;
+        for (const auto& pair : teme_) {
+            if (pair.second->incarcata()) rezultat.push_back(pair.second->snapshot());
+        }
+        return rezultat;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const ManagerRaspunsuri& manager) {
+        os << "ManagerRaspunsuri{ teme=[";
+        bool first = true;
+        for (const auto& pair : manager.teme_) {
+            if (!first) os << ", ";
+            os << pair.first << "(" << pair.second->snapshot()->calculeazaAdancime() << " noduri)";
+            first = false;
+        }
+        os << "] }";
+        return os;
+    }
+};
+
+#if AKINATOR_METRICI
+enum class FormatMetrici : std::uint8_t { JSON, Prometheus };
+
+// Exporta contoarele adunate de pe toate firele pentru versiunea publicata a fiecarei
+// teme (contoarele generatiilor mai vechi se ignora) si histogramele de timp. Apar
+// doar nodurile atinse macar o data.
+inline void scrieMetrici(std::ostream& os, const ManagerRaspunsuri& manager, FormatMetrici format) {
+    const InstantaneuMetrici metrici = Metrici::colecteaza();
+
+    if (format == FormatMetrici::JSON) {
+        json rezultat = {{"teme", json::array()}, {"timpi_ns", json::object()}};
+        for (const auto& arbore : manager.snapshoturi()) {
+            json noduri = json::array();
+            const auto it = metrici.arbori.find(arbore->generatie());
+            if (it != metrici.arbori.end()) {
+                for (IndexNod i = 0; i < it->second.size() && i < arbore->numarNoduri(); ++i) {
+                    const ContorNod& c = it->second[i];
+                    if (c.vizite == 0 && c.invalide == 0) continue;
+                    json nod = {{"nod", i}, {"text", arbore->text(i)}, {"vizite", c.vizite}};
+                    if (arbore->nod(i).esteFrunza()) {
+                        nod["ghiciri_gresite"] = c.ghiciri_gresite;
+                    } else {
+                        nod["da"] = c.da;
+                        nod["nu"] = c.nu;
+                        nod["invalide"] = c.invalide;
+                    }
+                    noduri.push_back(std::move(nod));
+                }
+            }
+            rezultat["teme"].push_back({{"tema", arbore->getTema()}, {"noduri", std::move(noduri)}});
+        }
+        for (std::size_t faza = 0; faza < NUMAR_FAZE; ++faza) {
+            const HistogramaTimp& h = metrici.timpi[faza];
+            rezultat["timpi_ns"][NUME_FAZE[faza]] = {
+                {"numar", h.total()}, {"medie", h.medieNs()}, {"p50", h.percentila(0.50)},
+                {"p90", h.percentila(0.90)}, {"p99", h.percentila(0.99)}, {"max", h.maximNs()}
+            };
+        }
+        os << rezultat.dump(2) << '\n';
+        return;
+    }
+
+    // Formatul text Prometheus (0.0.4); histogramele se exporta ca summary cu cuantile.
+    auto eticheta = [](std::string_view text) {
+        std::string rezultat;
+        for (const char c : text) {
+            if (c == '\\' || c == '"') rezultat.push_back('\\');
+            if (c == '\n') {
+                rezultat.append("\\n");
+            } else {
+                rezultat.push_back(c);
+            }
+        }
+        return rezultat;
+    };
+    struct Serie {
+        const char* nume;
+        const char* descriere;
+        std::uint64_t ContorNod::* camp;
+        bool pentru_frunze;
+    };
+    const std::array<Serie, 5> serii = {{
+        {"akinator_nod_vizite_total", "De cate ori a ajuns un joc in nod.", &ContorNod::vizite, true},
+        {"akinator_nod_da_total", "Raspunsuri da la intrebarea din nod.", &ContorNod::da, false},
+        {"akinator_nod_nu_total", "Raspunsuri nu la intrebarea din nod.", &ContorNod::nu, false},
+        {"akinator_nod_invalide_total", "Raspunsuri invalide la intrebarea din nod.", &ContorNod::invalide, false},
+        {"akinator_frunza_ghiciri_gresite_total", "Propuneri respinse in frunza.", &ContorNod::ghiciri_gresite, true},
+    }};
+    const auto arbori = manager.snapshoturi();
+    for (const Serie& serie : serii) {
+        os << "# HELP " << serie.nume << ' ' << serie.descriere << "\n# TYPE " << serie.nume << " counter\n";
+        for (const auto& arbore : arbori) {
+            const auto it = metrici.arbori.find(arbore->generatie());
+            if (it == metrici.arbori.end()) continue;
+            for (IndexNod i = 0; i < it->second.size() && i < arbore->numarNoduri(); ++i) {
+                const ContorNod& c = it->second[i];
+                const bool frunza = arbore->nod(i).esteFrunza();
+                if ((c.vizite == 0 && c.invalide == 0) || (frunza && !serie.pentru_frunze)
+                    || (!frunza && serie.camp == &ContorNod::ghiciri_gresite)) continue;
+                os << serie.nume << "{tema=\"" << eticheta(arbore->getTema()) << "\",nod=\"" << i
+                   << "\",text=\"" << eticheta(arbore->text(i)) << "\"} " << c.*serie.camp << '\n';
+            }
+        }
+    }
+    os << "# HELP akinator_durata_ns Durata fazelor unui joc, in nanosecunde.\n# TYPE akinator_durata_ns summary\n";
+    for (std::size_t faza = 0; faza < NUMAR_FAZE; ++faza) {
+        const HistogramaTimp& h = metrici.timpi[faza];
+        for (const double q : {0.5, 0.9, 0.99}) {
+            os << "akinator_durata_ns{faza=\"" << NUME_FAZE[faza] << "\",quantile=\"" << q << "\"} " << h.percentila(q) << '\n';
+        }
+        os << "akinator_durata_ns_sum{faza=\"" << NUME_FAZE[faza] << "\"} " << h.sumaNs() << '\n'
+           << "akinator_durata_ns_count{faza=\"" << NUME_FAZE[faza] << "\"} " << h.total() << '\n';
+    }
+}
+
+// Fisierele .json primesc JSON, orice altceva formatul Prometheus.
+inline void scrieMetriciInFisier(const std::string& fisier, const ManagerRaspunsuri& manager) {
+    const std::string temporar = fisier + ".tmp";
+    {
+        std::ofstream f(temporar, std::ios::binary | std::ios::trunc);
+        if (!f.is_open()) {
+            throw std::runtime_error("Nu se poate scrie " + temporar);
+        }
+        scrieMetrici(f, manager, std::filesystem::path(fisier).extension() == ".json" ? FormatMetrici::JSON : FormatMetrici::Prometheus);
+        if (!f) {
+            throw std::runtime_error("Scriere incompleta in " + temporar);
+        }
+    }
+    std::filesystem::rename(temporar, fisier);
+}
+#endif
+
+// -----------------------------------------------------------
+// 5. MOTOR PROBABILIST
+// -----------------------------------------------------------
+
+// log2 aproximat (eroare absoluta ~1e-4) fara apel de biblioteca, ca bucla de
+// scor de mai jos sa poata fi vectorizata de compilator.
+inline float log2Rapid(float x) {
+    const auto biti = std::bit_cast<std::uint32_t>(x);
+    const auto exponent = static_cast<float>(static_cast<int>((biti >> 23) & 0xFFU) - 127);
+    const float m = std::bit_cast<float>((biti & 0x007FFFFFU) | 0x3F800000U);  // mantisa in [1, 2)
+    return exponent + (-2.5056147f + (4.0496169f + (-2.0994023f + (0.6355111f - 0.0800109f * m) * m) * m) * m);
+}
+
+// Entropia (biti) unei variabile binare cu P(da) = x; 0 la capete.
+inline float entropieBinara(float x) {
+    x = std::clamp(x, 1e-7f, 1.0f - 1e-7f);
+    return -x * log2Rapid(x) - (1.0f - x) * log2Rapid(1.0f - x);
+}
+
+// Matricea entitate x intrebare extrasa dintr-un arbore: fiecare drum radacina-frunza
+// fixeaza raspunsurile la intrebarile de pe el, restul sunt necunoscute. Intrebarile cu
+// acelasi text din ramuri diferite sunt aceeasi coloana; frunzele cu acelasi nume sunt
+// aceeasi entitate (raspunsurile contradictorii devin necunoscute).
+//
+// Matricea unui arbore e aproape toata necunoscuta (o entitate are cat adancimea ei
+// raspunsuri cunoscute), asa ca se tine rara, in doua forme: pe randuri (CSR) pentru
+// scor, unde se aduna probabilitatile in acumulatori densi pe intrebare, si pe coloane
+// (CSC) pentru actualizarea Bayes, care atinge doar entitatile cu raspuns cunoscut.
+// Fiecare intrare e (index << 1) | raspuns_da.
+//
+// Optional, matricea se completeaza cu raspunsuri observate in jocuri (entitatea
+// confirmata la final si ce a raspuns jucatorul); cele din arbore au prioritate.
+struct Observatie {
+    std::string entitate;
+    std::string intrebare;
+    bool da = true;
+};
+
+class MotorProbabilist {
+public:
+    static constexpr float ZGOMOT = 0.05f;  // probabilitatea ca jucatorul sa raspunda gresit
+
+private:
+    std::shared_ptr<const ArboreAkinator> arbore_;
+    std::vector<std::string_view> intrebari_;   // vederi in pool-ul lui arbore_
+    std::vector<IndexNod> frunze_;               // o frunza reprezentativa pe entitate
+    std::vector<std::uint32_t> inceput_rand_;    // randul e: [inceput_rand_[e], inceput_rand_[e + 1])
+    std::vector<std::uint32_t> randuri_;         // (intrebare << 1) | da, sortat pe rand
+    std::vector<std::uint32_t> inceput_coloana_;
+    std::vector<std::uint32_t> coloane_;         // (entitate << 1) | da
+    std::vector<std::uint32_t> numar_da_;        // pe intrebare: cate entitati raspund da / nu
+    std::vector<std::uint32_t> numar_nu_;
+
+public:
+    explicit MotorProbabilist(std::shared_ptr<const ArboreAkinator> arbore, std::span<const Observatie> observatii = {}) :
+        arbore_(std::move(arbore)) {
+        std::unordered_map<std::string_view, std::uint32_t> id_intrebare;
+        std::unordered_map<std::string_view, std::uint32_t> id_entitate;
+        std::vector<std::vector<std::uint32_t>> randuri;
+
+        // Parcurgere in adancime cu stiva explicita; drum tine raspunsurile pana la nodul curent.
+        struct Cadru {
+            IndexNod nod;
+            std::uint32_t adancime;
+            std::uint32_t atribut;  // muchia prin care am ajuns aici
+        };
+        std::vector<Cadru> stiva;
+        std::vector<std::uint32_t> drum;
+        if (arbore_->radacina() != NOD_NUL) stiva.push_back({arbore_->radacina(), 0, 0});
+        while (!stiva.empty()) {
+            const Cadru c = stiva.back();
+            stiva.pop_back();
+            drum.resize(c.adancime);
+            if (c.adancime > 0) drum.back() = c.atribut;
+
+            const Nod& n = arbore_->nod(c.nod);
+            if (n.esteFrunza()) {
+                const auto [it, nou] = id_entitate.emplace(arbore_->text(c.nod), static_cast<std::uint32_t>(frunze_.size()));
+                if (nou) {
+                    frunze_.push_back(c.nod);
+                    randuri.emplace_back();
+                }
+                auto& rand = randuri[it->second];
+                rand.insert(rand.end(), drum.begin(), drum.end());
+                continue;
+            }
+
+            const auto [it, nou] = id_intrebare.emplace(arbore_->text(c.nod), static_cast<std::uint32_t>(intrebari_.size()));
+            if (nou) intrebari_.push_back(it->first);
+            const std::uint32_t q = it->second;
+            if (n.nu != NOD_NUL) stiva.push_back({n.nu, c.adancime + 1, q << 1});
+            if (n.da != NOD_NUL) stiva.push_back({n.da, c.adancime + 1, (q << 1) | 1U});
+        }
+
+        // Observatiile despre entitati sau intrebari care nu (mai) sunt in arbore se ignora.
+        std::vector<std::vector<std::uint32_t>> observate(randuri.size());
+        for (const Observatie& o : observatii) {
+            const auto e = id_entitate.find(o.entitate);
+            const auto q = id_intrebare.find(o.intrebare);
+            if (e == id_entitate.end() || q == id_intrebare.end()) continue;
+            observate[e->second].push_back((q->second << 1) | (o.da ? 1U : 0U));
+        }
+
+        // Randuri sortate, fara dubluri si fara raspunsuri contradictorii.
+        inceput_rand_.push_back(0);
+        std::vector<std::uint32_t> numar_pe_coloana(intrebari_.size(), 0);
+        std::vector<std::uint32_t> curat;
+        for (std::size_t e = 0; e < randuri.size(); ++e) {
+            curat.clear();
+            for (auto* rand : {&randuri[e], &observate[e]}) {
+                std::sort(rand->begin(), rand->end());
+                rand->erase(std::unique(rand->begin(), rand->end()), rand->end());
+                const std::size_t din_arbore = curat.size();
+                for (std::size_t i = 0; i < rand->size(); ++i) {
+                    const std::uint32_t q = (*rand)[i] >> 1;
+                    const bool contradictie = (i + 1 < rand->size() && ((*rand)[i + 1] >> 1) == q)
+                                           || (i > 0 && ((*rand)[i - 1] >> 1) == q);
+                    const bool cunoscut = std::binary_search(curat.begin(), curat.begin() + static_cast<std::ptrdiff_t>(din_arbore), q << 1,
+                        [](std::uint32_t a, std::uint32_t b) { return (a >> 1) < (b >> 1); });
+                    if (!contradictie && !cunoscut) curat.push_back((*rand)[i]);
+                }
+            }
+            std::sort(curat.begin(), curat.end());
+            for (const std::uint32_t a : curat) ++numar_pe_coloana[a >> 1];
+            randuri_.insert(randuri_.end(), curat.begin(), curat.end());
+            inceput_rand_.push_back(static_cast<std::uint32_t>(randuri_.size()));
+        }
+
+        inceput_coloana_.resize(intrebari_.size() + 1, 0);
+        for (std::size_t q = 0; q < intrebari_.size(); ++q) {
+            inceput_coloana_[q + 1] = inceput_coloana_[q] + numar_pe_coloana[q];
+        }
+        coloane_.resize(randuri_.size());
+        std::vector<std::uint32_t> pozitie(inceput_coloana_.begin(), inceput_coloana_.end() - 1);
+        for (std::uint32_t e = 0; e + 1 < inceput_rand_.size(); ++e) {
+            for (std::uint32_t i = inceput_rand_[e]; i < inceput_rand_[e + 1]; ++i) {
+                coloane_[pozitie[randuri_[i] >> 1]++] = (e << 1) | (randuri_[i] & 1U);
+            }
+        }
+
+        numar_da_.assign(intrebari_.size(), 0);
+        numar_nu_.assign(intrebari_.size(), 0);
+        for (const std::uint32_t a : randuri_) ++(a & 1U ? numar_da_ : numar_nu_)[a >> 1];
+    }
+
+    std::size_t numarEntitati() const { return frunze_.size(); }
+    std::size_t numarIntrebari() const { return intrebari_.size(); }
+    std::string_view intrebare(std::uint32_t q) const { return intrebari_[q]; }
+    Entitate entitate(std::uint32_t e) const { return arbore_->entitate(frunze_[e]); }
+    const ArboreAkinator& arbore() const { return *arbore_; }
+    std::span<const std::uint32_t> numarDa() const { return numar_da_; }
+    std::span<const std::uint32_t> numarNu() const { return numar_nu_; }
+
+    std::span<const std::uint32_t> rand(std::uint32_t e) const {
+        return std::span<const std::uint32_t>(randuri_).subspan(inceput_rand_[e], inceput_rand_[e + 1] - inceput_rand_[e]);
+    }
+
+    std::span<const std::uint32_t> coloana(std::uint32_t q) const {
+        return std::span<const std::uint32_t>(coloane_).subspan(inceput_coloana_[q], inceput_coloana_[q + 1] - inceput_coloana_[q]);
+    }
+
+    // 1 = da, 0 = nu, -1 = necunoscut.
+    int raspunsCunoscut(std::uint32_t e, std::uint32_t q) const {
+        const auto r = rand(e);
+        const auto it = std::lower_bound(r.begin(), r.end(), q << 1);
+        if (it == r.end() || (*it >> 1) != q) return -1;
+        return static_cast<int>(*it & 1U);
+    }
+};
+
+// Un joc pe motorul probabilist: o distributie peste entitati, actualizata Bayes la
+// fiecare raspuns, si urmatoarea intrebare aleasa dupa castigul informational asteptat.
+// Un raspuns gresit doar scade probabilitatea entitatii corecte, nu o elimina.
+class SesiuneProbabilista {
+public:
+    enum class Raspuns : std::uint8_t { Da, Nu, NuStiu };
+
+    static constexpr float PRAG_GHICIRE = 0.85f;
+    static constexpr float PRAG_DOMINARE_MINIM = 0.5f;  // sau: peste 0.5 si de 10 ori mai probabil
+    static constexpr float PRAG_DOMINARE = 10.0f;       // decat urmatorul candidat
+    static constexpr float CASTIG_MINIM = 1e-3f;   // biti
+    static constexpr std::size_t INTREBARI_MAXIME = 60;
+    static constexpr int PROPUNERI_MAXIME = 3;
+
+private:
+    const MotorProbabilist* motor_;
+    // Greutati nenormalizate; probabilitatea e greutate / total_. Sumele pe intrebare
+    // (masa entitatilor care raspund da / nu) se tin la zi la fiecare raspuns, atingand
+    // doar entitatile din coloana intrebarii, asa ca alegerea nu mai parcurge matricea.
+    std::vector<double> greutate_;
+    double total_ = 0.0;
+    std::vector<double> suma_da_;
+    std::vector<double> suma_nu_;
+    std::vector<std::uint8_t> intrebat_;
+    std::size_t intrebari_puse_ = 0;
+
+    void schimbaGreutatea(std::uint32_t e, double noua) {
+        const double delta = noua - greutate_[e];
+        greutate_[e] = noua;
+        total_ += delta;
+        for (const std::uint32_t a : motor_->rand(e)) {
+            (a & 1U ? suma_da_ : suma_nu_)[a >> 1] += delta;
+        }
+    }
+
+    // Inmultirile repetate cu factori != 1 ar duce greutatile spre depasire; scalarea
+    // e comuna tuturor termenilor, deci nu schimba nici probabilitatile, nici scorurile.
+    void rescaleaza() {
+        if (total_ > 1e-100 && total_ < 1e100) return;
+        if (total_ <= 0.0) return;
+        const double factor = 1.0 / total_;
+        for (double& x : greutate_) x *= factor;
+        for (double& x : suma_da_) x *= factor;
+        for (double& x : suma_nu_) x *= factor;
+        total_ = 1.0;
+    }
+
+public:
+    explicit SesiuneProbabilista(const MotorProbabilist& motor) :
+        motor_(&motor),
+        greutate_(motor.numarEntitati(), 1.0),
+        total_(static_cast<double>(motor.numarEntitati())),
+        suma_da_(motor.numarDa().begin(), motor.numarDa().end()),
+        suma_nu_(motor.numarNu().begin(), motor.numarNu().end()),
+        intrebat_(motor.numarIntrebari(), 0) {}
+
+    std::size_t intrebariPuse() const { return intrebari_puse_; }
+
+    std::optional<std::uint32_t> celMaiProbabil() const {
+        if (greutate_.empty()) return std::nullopt;
+        const auto it = std::max_element(greutate_.begin(), greutate_.end());
+        if (*it <= 0.0) return std::nullopt;
+        return static_cast<std::uint32_t>(it - greutate_.begin());
+    }
+
+    float probabilitate(std::uint32_t e) const {
+        return total_ > 0.0 ? static_cast<float>(greutate_[e] / total_) : 0.0f;
+    }
+
+    // Intrebarea cu cel mai mare castig informational asteptat, sau nullopt daca e
+    // momentul unei propuneri (o entitate e destul de probabila, ii domina clar pe
+    // ceilalti candidati sau nicio intrebare nu mai aduce informatie).
+    std::optional<std::uint32_t> urmatoareaIntrebare() {
+        double primul = 0.0;
+        double al_doilea = 0.0;
+        for (const double x : greutate_) {
+            al_doilea = std::max(al_doilea, std::min(primul, x));
+            primul = std::max(primul, x);
+        }
+        if (primul <= 0.0 || total_ <= 0.0 || intrebari_puse_ >= INTREBARI_MAXIME) return std::nullopt;
+        const double p_primul = primul / total_;
+        const bool domina = p_primul >= PRAG_DOMINARE_MINIM && primul >= PRAG_DOMINARE * al_doilea;
+        if (p_primul >= PRAG_GHICIRE || domina) return std::nullopt;
+
+        // IG = H(raspuns) - H(raspuns | entitate). Pentru o entitate cu raspuns cunoscut
+        // H(raspuns | e) = H(ZGOMOT), pentru una necunoscuta e 1 bit. Bucla e fara ramificatii.
+        const float h_zgomot = entropieBinara(MotorProbabilist::ZGOMOT);
+        const float inclinare = 0.5f - MotorProbabilist::ZGOMOT;
+        const double invers_total = 1.0 / total_;
+        float castig_maxim = CASTIG_MINIM;
+        std::optional<std::uint32_t> alegere;
+        const std::size_t n = suma_da_.size();
+        for (std::size_t q = 0; q < n; ++q) {
+            const float da = static_cast<float>(suma_da_[q] * invers_total);
+            const float nu = static_cast<float>(suma_nu_[q] * invers_total);
+            const float cunoscut = std::clamp(da + nu, 0.0f, 1.0f);
+            const float p_da = 0.5f + inclinare * (da - nu);
+            const float castig = (entropieBinara(p_da) - h_zgomot * cunoscut - (1.0f - cunoscut))
+                               * static_cast<float>(1 - intrebat_[q]);
+            if (castig > castig_maxim) {
+                castig_maxim = castig;
+                alegere = static_cast<std::uint32_t>(q);
+            }
+        }
+        return alegere;
+    }
+
+    // Actualizare Bayes. Factorul 1/2 al entitatilor cu raspuns necunoscut e comun
+    // tuturor si dispare la normalizare, deci se ating doar intrarile coloanei.
+    void raspunde(std::uint32_t q, Raspuns r) {
+        intrebat_[q] = 1;
+        ++intrebari_puse_;
+        if (r == Raspuns::NuStiu) return;
+
+        const double potrivire = (1.0 - MotorProbabilist::ZGOMOT) * 2.0;
+        const double nepotrivire = MotorProbabilist::ZGOMOT * 2.0;
+        const std::uint32_t asteptat = r == Raspuns::Da ? 1U : 0U;
+        for (const std::uint32_t intrare : motor_->coloana(q)) {
+            const std::uint32_t e = intrare >> 1;
+            schimbaGreutatea(e, greutate_[e] * ((intrare & 1U) == asteptat ? potrivire : nepotrivire));
+        }
+        rescaleaza();
+    }
+
+    void respinge(std::uint32_t e) {
+        schimbaGreutatea(e, 0.0);
+        rescaleaza();
+    }
+};
+
+// Intrebari pe joc pentru un arbore: pentru fiecare entitate (dupa nume) adancimea celei
+// mai adanci frunze a ei, mediata simplu si ponderat cu frecventa observata. O entitate
+// cu mai multe frunze se numara pesimist: jucatorul poate ajunge la oricare dintre ele.
+struct CostArbore {
+    std::size_t entitati = 0;
+    double medie = 0.0;
+    double medie_ponderata = 0.0;
+    std::size_t maxim = 0;
+};
+
+inline CostArbore masoaraArbore(const ArboreAkinator& arbore,
+                                const std::unordered_map<std::string_view, double>& frecvente) {
+    std::unordered_map<std::string_view, std::size_t> adancime;
+    std::vector<std::pair<IndexNod, std::size_t>> stiva;
+    if (arbore.radacina() != NOD_NUL) stiva.emplace_back(arbore.radacina(), 0);
+    while (!stiva.empty()) {
+        const auto [nod, intrebari] = stiva.back();
+        stiva.pop_back();
+        const Nod& n = arbore.nod(nod);
+        if (n.esteFrunza()) {
+            const auto [it, nou] = adancime.emplace(arbore.text(nod), intrebari);
+            if (!nou) it->second = std::max(it->second, intrebari);
+            continue;
+        }
+        if (n.nu != NOD_NUL) stiva.emplace_back(n.nu, intrebari + 1);
+        if (n.da != NOD_NUL) stiva.emplace_back(n.da, intrebari + 1);
+    }
+
+    CostArbore cost;
+    double suma = 0.0;
+    double suma_ponderata = 0.0;
+    double total_ponderi = 0.0;
+    for (const auto& [nume, intrebari] : adancime) {
+        const auto it = frecvente.find(nume);
+        const double pondere = it != frecvente.end() ? it->second : 1.0;
+        suma += static_cast<double>(intrebari);
+        suma_ponderata += pondere * static_cast<double>(intrebari);
+        total_ponderi += pondere;
+        cost.maxim = std::max(cost.maxim, intrebari);
+    }
+    cost.entitati = adancime.size();
+    if (cost.entitati > 0) cost.medie = suma / static_cast<double>(cost.entitati);
+    if (total_ponderi > 0.0) cost.medie_ponderata = suma_ponderata / total_ponderi;
+    return cost;
+}
+
+// Reconstruieste arborele unei teme din matricea entitate x intrebare a motorului,
+// de sus in jos, ca la arborii de decizie: la fiecare nod alege intrebarea cu cea mai
+// mare scadere asteptata a entropiei entitatilor ramase, ponderate cu frecventele
+// observate. Se folosesc doar perechi (intrebare, raspuns) cunoscute de motor: din
+// arbore si, daca exista, observate in jocuri. Intai se cauta o intrebare cunoscuta de
+// toate entitatile ramase; cat timp ele vin din acelasi arbore exista mereu una, cea din
+// stramosul lor comun. Doar altfel (raspunsuri contradictorii eliminate) se accepta o
+// intrebare pe care unele nu o cunosc, iar acestea ajung pe ambele ramuri.
+//
+// Cu matricea extrasa doar din arbore rezultatul e chiar arborele initial: frunza unei
+// entitati cere intrebarea din stramosul comun cu fiecare alta entitate, adica exact
+// drumul ei. Ordinea intrebarilor se poate schimba doar cu raspunsuri observate.
+class OptimizatorArbore {
+private:
+    const MotorProbabilist& motor_;
+    std::vector<double> pondere_;
+
+    // Acumulatori pe intrebare, refolositi intre noduri; se reseteaza doar cei atinsi.
+    // Pentru entropia unei submultimi ajung masa ei si suma de w * log2(w).
+    std::vector<double> masa_da_;
+    std::vector<double> masa_nu_;
+    std::vector<double> wlog_da_;
+    std::vector<double> wlog_nu_;
+    std::vector<std::uint32_t> numar_da_;
+    std::vector<std::uint32_t> numar_nu_;
+    std::vector<std::uint32_t> atinse_;
+    std::size_t ramificari_incomplete_ = 0;
+
+    static double entropie(double masa, double wlog) {
+        return masa > 0.0 ? std::log2(masa) - wlog / masa : 0.0;
+    }
+
+    struct Alegere {
+        std::uint32_t intrebare;
+        std::size_t necunoscute;  // entitati fara raspuns, puse pe ambele ramuri
+    };
+
+    std::optional<Alegere> alegeIntrebarea(const std::vector<std::uint32_t>& entitati, bool permite_necunoscute) {
+        double masa = 0.0;
+        double wlog = 0.0;
+        for (const std::uint32_t e : entitati) {
+            const double w = pondere_[e];
+            const double wl = w * std::log2(w);
+            masa += w;
+            wlog += wl;
+            for (const std::uint32_t a : motor_.rand(e)) {
+                const std::uint32_t q = a >> 1;
+                if (numar_da_[q] + numar_nu_[q] == 0) atinse_.push_back(q);
+                if (a & 1U) {
+                    masa_da_[q] += w;
+                    wlog_da_[q] += wl;
+                    ++numar_da_[q];
+                } else {
+                    masa_nu_[q] += w;
+                    wlog_nu_[q] += wl;
+                    ++numar_nu_[q];
+                }
+            }
+        }
+
+        // Castig = H(S) - P(da) * H(da + necunoscute) - P(nu) * H(nu + necunoscute), cu
+        // entitatile necunoscute presupuse jumatate pe fiecare ramura. Fara necunoscute
+        // e exact entropia raspunsului. La egalitate, cea cu mai putine necunoscute, apoi cea mai veche.
+        const double h_total = entropie(masa, wlog);
+        std::optional<Alegere> alegere;
+        double castig_maxim = -std::numeric_limits<double>::infinity();
+        for (const std::uint32_t q : atinse_) {
+            if (numar_da_[q] == 0 || numar_nu_[q] == 0) continue;
+            const std::size_t necunoscute = entitati.size() - numar_da_[q] - numar_nu_[q];
+            if (necunoscute > 0 && !permite_necunoscute) continue;
+            const double masa_necunoscuta = std::max(0.0, masa - masa_da_[q] - masa_nu_[q]);
+            const double wlog_necunoscut = wlog - wlog_da_[q] - wlog_nu_[q];
+            const double castig = h_total
+                - (masa_da_[q] + masa_necunoscuta / 2) / masa * entropie(masa_da_[q] + masa_necunoscuta, wlog_da_[q] + wlog_necunoscut)
+                - (masa_nu_[q] + masa_necunoscuta / 2) / masa * entropie(masa_nu_[q] + masa_necunoscuta, wlog_nu_[q] + wlog_necunoscut);
+            const bool mai_bun = !alegere || castig > castig_maxim
+                || (castig == castig_maxim && std::pair(necunoscute, q) < std::pair(alegere->necunoscute, alegere->intrebare));
+            if (mai_bun) {
+                castig_maxim = castig;
+                alegere = Alegere{q, necunoscute};
+            }
+        }
+
+        for (const std::uint32_t q : atinse_) {
+            masa_da_[q] = masa_nu_[q] = wlog_da_[q] = wlog_nu_[q] = 0.0;
+            numar_da_[q] = numar_nu_[q] = 0;
+        }
+        atinse_.clear();
+        return alegere;
+    }
+
+public:
+    // pondere: cate una pe entitatea motorului, strict pozitiva.
+    OptimizatorArbore(const MotorProbabilist& motor, std::vector<double> pondere) :
+        motor_(motor),
+        pondere_(std::move(pondere)),
+        masa_da_(motor.numarIntrebari(), 0.0),
+        masa_nu_(motor.numarIntrebari(), 0.0),
+        wlog_da_(motor.numarIntrebari(), 0.0),
+        wlog_nu_(motor.numarIntrebari(), 0.0),
+        numar_da_(motor.numarIntrebari(), 0),
+        numar_nu_(motor.numarIntrebari(), 0) {}
+
+    std::size_t ramificariIncomplete() const { return ramificari_incomplete_; }
+
+    // Fara recursie; nodurile se aloca in preordine ("da" inaintea lui "nu"), ca la incarcare.
+    ArboreAkinator construieste() {
+        ArboreAkinator nou(motor_.arbore().getTema());
+        if (motor_.numarEntitati() == 0) return nou;
+        auto tabela = nou.tabelaNoua();
+
+        struct Cadru {
+            std::vector<std::uint32_t> entitati;
+            IndexNod parinte;
+            bool da;
+        };
+        std::vector<std::uint32_t> toate(motor_.numarEntitati());
+        for (std::uint32_t e = 0; e < toate.size(); ++e) toate[e] = e;
+        std::vector<Cadru> stiva;
+        stiva.push_back({std::move(toate), NOD_NUL, false});
+
+        while (!stiva.empty()) {
+            Cadru c = std::move(stiva.back());
+            stiva.pop_back();
+
+            IndexNod index;
+            if (c.entitati.size() == 1) {
+                const Entitate e = motor_.entitate(c.entitati[0]);
+                Nod frunza;
+                frunza.text = nou.interneaza(e.nume, tabela);
+                frunza.entitate = static_cast<std::uint32_t>(nou.entitati_.size());
+                nou.entitati_.push_back({nou.interneaza(e.domeniu, tabela), nou.interneaza(e.tip, tabela)});
+                index = nou.adaugaNod(frunza);
+            } else {
+                std::optional<Alegere> alegere = alegeIntrebarea(c.entitati, false);
+                if (!alegere) alegere = alegeIntrebarea(c.entitati, true);
+                if (!alegere) {
+                    throw std::runtime_error("Nicio intrebare nu deosebeste entitatile '" + std::string(motor_.entitate(c.entitati[0]).nume)
+                                             + "' si '" + std::string(motor_.entitate(c.entitati[1]).nume)
+                                             + "' (aceeasi intrebare apare pe drum cu raspunsuri opuse?).");
+                }
+                if (alegere->necunoscute > 0) ++ramificari_incomplete_;
+
+                Cadru da{{}, NOD_NUL, true};
+                Cadru nu{{}, NOD_NUL, false};
+                for (const std::uint32_t e : c.entitati) {
+                    const int raspuns = motor_.raspunsCunoscut(e, alegere->intrebare);
+                    if (raspuns != 0) da.entitati.push_back(e);
+                    if (raspuns != 1) nu.entitati.push_back(e);
+                }
+
+                Nod intern;
+                intern.text = nou.interneaza(motor_.intrebare(alegere->intrebare), tabela);
+                index = nou.adaugaNod(intern);
+                da.parinte = nu.parinte = index;
+                stiva.push_back(std::move(nu));
+                stiva.push_back(std::move(da));
+            }
+
+            if (c.parinte == NOD_NUL) {
+                nou.radacina_ = index;
+            } else if (c.da) {
+                nou.noduri_[c.parinte].da = index;
+            } else {
+                nou.noduri_[c.parinte].nu = index;
+            }
+        }
+        nou.noduri_.shrink_to_fit();
+        nou.entitati_.shrink_to_fit();
+        nou.pool_.shrink_to_fit();
+        nou.generatie_ = urmatoareaGeneratie();
+        nou.indexeaza();
+        return nou;
+    }
+};
+
+// -----------------------------------------------------------
+// 6. JOC AKINATOR (CONTROLLER)
+// -----------------------------------------------------------
+
+// Dupa o propunere respinsa: intreaba daca jucatorul vrea sa adauge entitatea la care s-a
+// gandit si ii cere, pe rand, numele, domeniul, tipul, o intrebare care o deosebeste de
+// propunere si raspunsul ei. Primeste cate un cuvant, deci merge si peste un flux, si pe
+// conexiunile serverului; un camp cu mai multe cuvinte se scrie intre ghilimele. Orice
+// raspuns in afara de "da" la prima intrebare, sau un camp gol (""), renunta.
+class DialogInvatare {
+public:
+    enum class Pas : std::uint8_t { Confirmare, Nume, Domeniu, Tip, Intrebare, Raspuns, Gata, Renuntat };
+
+private:
+    Lectie lectie_;
+    std::string propunere_;
+    Pas pas_ = Pas::Confirmare;
+    bool intre_ghilimele_ = false;
+
+    std::string* campCurent() {
+        switch (pas_) {
+            case Pas::Nume: return &lectie_.nume;
+            case Pas::Domeniu: return &lectie_.domeniu;
+            case Pas::Tip: return &lectie_.tip;
+            case Pas::Intrebare: return &lectie_.intrebare;
+            default: return nullptr;
+        }
+    }
+
+public:
+    DialogInvatare(std::string cale, std::string_view propunere) : propunere_(propunere) {
+        lectie_.cale = std::move(cale);
+    }
+
+    Pas pas() const { return pas_; }
+    bool terminat() const { return pas_ == Pas::Gata || pas_ == Pas::Renuntat; }
+    // Un camp intre ghilimele inca neinchis: urmatorul cuvant il continua.
+    bool inCamp() const { return intre_ghilimele_; }
+    const Lectie& lectie() const { return lectie_; }
+
+    template <IesireText Iesire>
+    void scrieIntrebarea(Iesire& iesire) const {
+        switch (pas_) {
+            case Pas::Confirmare:
+                iesire.append("Vrei sa ma inveti la ce te-ai gandit (da/nu)?\n");
+                break;
+            case Pas::Nume:
+                iesire.append("Numele (intre ghilimele daca are mai multe cuvinte):\n");
+                break;
+            case Pas::Domeniu:
+                iesire.append("Domeniul:\n");
+                break;
+            case Pas::Tip:
+                iesire.append("Tipul:\n");
+                break;
+            case Pas::Intrebare:
+                iesire.append("O intrebare care deosebeste ");
+                iesire.append(lectie_.nume);
+                iesire.append(" de ");
+                iesire.append(propunere_);
+                iesire.append(":\n");
+                break;
+            case Pas::Raspuns:
+                iesire.append("Pentru ");
+                iesire.append(lectie_.nume);
+                iesire.append(", raspunsul este (da/nu)?\n");
+                break;
+            case Pas::Gata:
+            case Pas::Renuntat:
+                break;
+        }
+    }
+
+    // Intoarce false doar pentru un raspuns final care nu e "da"/"nu"; pasul ramane acelasi.
+    bool primeste(std::string_view cuvant) {
+        if (pas_ == Pas::Confirmare) {
+            pas_ = cuvant == "da" ? Pas::Nume : Pas::Renuntat;
+            return true;
+        }
+        if (pas_ == Pas::Raspuns) {
+            if (cuvant != "da" && cuvant != "nu") return false;
+            lectie_.raspuns_da = cuvant == "da";
+            pas_ = Pas::Gata;
+            return true;
+        }
+        std::string* camp = campCurent();
+        if (!camp) return true;
+
+        if (!intre_ghilimele_ && cuvant.starts_with('"')) {
+            intre_ghilimele_ = true;
+            cuvant.remove_prefix(1);
+            camp->clear();
+        } else if (intre_ghilimele_) {
+            camp->push_back(' ');
+        }
+        if (intre_ghilimele_) {
+            const bool capat = cuvant.ends_with('"');
+            if (capat) cuvant.remove_suffix(1);
+            camp->append(cuvant);
+            if (!capat) return true;
+            intre_ghilimele_ = false;
+        } else {
+            camp->assign(cuvant);
+        }
+        pas_ = camp->empty() ? Pas::Renuntat : static_cast<Pas>(static_cast<std::uint8_t>(pas_) + 1);
+        return true;
+    }
+};
+
+// Ce scrie ruleazaLot pentru fiecare sesiune (vezi acolo).
+enum class FormatLot : std::uint8_t { Rezultat, Transcriere, Evenimente };
+
+class JocAkinator {
+private:
+    ManagerRaspunsuri manager_;
+    std::shared_ptr<const MotorProbabilist> motor_;  // construit pentru snapshot-ul curent, la cerere
+    std::string tema_;                                // refolosite intre jocuri
+    std::string cuvant_;
+    TranscriereJoc transcriere_;
+
+    // Dupa un joc care s-a terminat cu o propunere respinsa (transcriere_.sesiune()),
+    // ruleaza DialogInvatare peste restul fluxului; intrebarile lui merg in iesire.
+    template <IesireText Iesire>
+    std::optional<Lectie> citesteLectie(std::istream& is, Iesire& iesire) {
+        const SesiuneJoc& sesiune = transcriere_.sesiune();
+        if (!sesiune.aGresit()) return std::nullopt;
+        DialogInvatare dialog(sesiune.cale(), sesiune.propunere().nume);
+        dialog.scrieIntrebarea(iesire);
+        while (!dialog.terminat() && is >> cuvant_) {
+            if (!dialog.primeste(cuvant_)) iesire.append("Raspuns invalid. Incearca 'da' sau 'nu'.\n");
+            if (!dialog.inCamp()) dialog.scrieIntrebarea(iesire);
+        }
+        if (dialog.pas() != DialogInvatare::Pas::Gata) return std::nullopt;
+        return dialog.lectie();
+    }
+
+    const MotorProbabilist& motorPentruTemaCurenta() {
+        if (!motor_ || &motor_->arbore() != manager_.getArboreCurent()) {
+            motor_ = std::make_shared<const MotorProbabilist>(manager_.getSnapshotCurent());
+        }
+        return *motor_;
+    }
+
+public:
+    JocAkinator() = default;
+    // Refoloseste temele deja incarcate ale altui manager (copierea e O(1) pe tema).
+    explicit JocAkinator(ManagerRaspunsuri manager) : manager_(std::move(manager)) {}
+
+    template <IesireText Iesire>
+    void ruleazaSilentios(std::istream& is, Iesire& iesire) {
+        if (!(is >> tema_)) {
+            iesire.append("Eroare: Nu s-a putut citi tema din fisier.\n");
+            return;
+        }
+
+        try {
+            manager_.selecteazaTema(tema_);
+
+            std::optional<Entitate> rezultat;
+            {
+                MasuraJoc masura;
+                rezultat = transcriere_.joaca(*manager_.getArboreCurent(), is, masura.activ(), iesire, &masura);
+            }
+
+            iesire.append(rezultat ? rezultat->nume : "Negasit");
+            iesire.append("\n");
+
+            if (const std::optional<Lectie> lectie = citesteLectie(is, iesire)) {
+                manager_.invata(tema_, *lectie);
+                iesire.append("Am invatat: ");
+                iesire.append(lectie->nume);
+                iesire.append("\n");
+            }
+        } catch (const std::runtime_error& e) {
+            iesire.append("Eroare: ");
+            iesire.append(e.what());
+            iesire.append("\n");
+        }
+    }
+
+    void ruleazaSilentios(std::istream& is, std::ostream& os) {
+        IesireFlux iesire(os);
+        ruleazaSilentios(is, iesire);
+    }
+
+    // Acelasi joc, cu motorul probabilist in locul parcurgerii arborelui. Un raspuns
+    // care nu e "da"/"nu" conteaza ca "nu stiu"; dupa o propunere respinsa jocul
+    // continua, de cel mult GHICIRI_MAXIME ori.
+    void ruleazaProbabilist(std::istream& is, std::ostream& os) {
+        std::string tema;
+
+        if (!(is >> tema)) {
+            os << "Eroare: Nu s-a putut citi tema din fisier." << std::endl;
+            return;
+        }
+
+        try {
+            manager_.selecteazaTema(tema);
+        } catch (const std::runtime_error& e) {
+            os << "Eroare: " << e.what() << "\n";
+            return;
+        }
+
+        const MotorProbabilist& motor = motorPentruTemaCurenta();
+        SesiuneProbabilista sesiune(motor);
+        std::string raspuns;
+        int ghiciri = 0;
+
+        while (ghiciri < SesiuneProbabilista::PROPUNERI_MAXIME) {
+            if (const auto q = sesiune.urmatoareaIntrebare()) {
+                os << "Intrebare: " << motor.intrebare(*q) << " (da/nu)?\n";
+                if (!(is >> raspuns)) {
+                    os << "Eroare la citirea raspunsului din fisier.\nNegasit\n";
+                    return;
+                }
+                if (raspuns == "da") {
+                    sesiune.raspunde(*q, SesiuneProbabilista::Raspuns::Da);
+                } else if (raspuns == "nu") {
+                    sesiune.raspunde(*q, SesiuneProbabilista::Raspuns::Nu);
+                } else {
+                    os << "Raspuns necunoscut; trec la alta intrebare.\n";
+                    sesiune.raspunde(*q, SesiuneProbabilista::Raspuns::NuStiu);
+                }
+                continue;
+            }
+
+            const auto favorit = sesiune.celMaiProbabil();
+            if (!favorit) break;
+            const Entitate propunere = motor.entitate(*favorit);
+            os << "M-am gandit la: " << propunere.nume << ". E corect (da/nu)?\n";
+            if (!(is >> raspuns)) {
+                os << "Eroare la citirea raspunsului final din fisier.\nNegasit\n";
+                return;
+            }
+            if (raspuns == "da") {
+                os << propunere.nume << "\n";
+                return;
+            }
+            sesiune.respinge(*favorit);
+            ++ghiciri;
+        }
+        os << "Negasit\n";
+    }
+
+    // Rejoaca sesiuni inregistrate, cate una pe linie: "<tema> <raspuns> <raspuns> ...".
+    // Liniile goale si cele care incep cu '#' se sar. Fiecare rezultat se scrie imediat
+    // in iesire, ca "nr<TAB>tema<TAB>rezultat"; cu FormatLot::Transcriere se scrie jocul
+    // complet, ca in ruleazaSilentios, iar cu FormatLot::Evenimente se adauga evenimentele
+    // jocului, cronometrate. Dupa o propunere respinsa, restul liniei e raspunsul la
+    // DialogInvatare; o lectie invatata adauga coloana "invatat: <nume>". Sesiunile se
+    // numeroteaza de la primul_numar.
+    template <IesireText Iesire>
+    HistogramaTimp ruleazaLot(std::istream& sesiuni, Iesire& iesire, FormatLot format, std::uint64_t primul_numar) {
+        HistogramaTimp latente;
+        FluxText linie_is;
+        std::string linie;
+        std::uint64_t numar = primul_numar - 1;
+
+        while (std::getline(sesiuni, linie)) {
+            if (linie.empty() || linie[0] == '#') continue;
+            ++numar;
+            linie_is.seteaza(linie);
+
+            const auto start = std::chrono::steady_clock::now();
+            if (format == FormatLot::Transcriere) {
+                ruleazaSilentios(linie_is, iesire);
+                iesire.append("\n");
+            } else {
+                adaugaNumar(iesire, numar);
+                iesire.append("\t");
+                if (!(linie_is >> tema_)) {
+                    iesire.append("-\tEroare: sesiune fara tema\n");
+                } else {
+                    iesire.append(tema_);
+                    iesire.append("\t");
+                    try {
+                        manager_.selecteazaTema(tema_);
+                        const ArboreAkinator& arbore = *manager_.getArboreCurent();
+                        IesireNula nula;
+                        {
+                            // Scrierea evenimentelor e timpul de iesire al jocului.
+                            MasuraJoc masura;
+                            const bool evenimente = format == FormatLot::Evenimente;
+                            const std::optional<Entitate> rezultat =
+                                transcriere_.joaca(arbore, linie_is, evenimente || masura.activ(), nula, &masura);
+                            iesire.append(rezultat ? rezultat->nume : "Negasit");
+                            if (evenimente) {
+                                const Cronometru scriere = masura.iesire();
+                                scrieEvenimente(iesire);
+                                masura.adaugaIesire(scriere);
+                            }
+                        }
+                        if (const std::optional<Lectie> lectie = citesteLectie(linie_is, nula)) {
+                            iesire.append("\t");
+                            manager_.invata(tema_, *lectie);
+                            iesire.append("invatat: ");
+                            iesire.append(lectie->nume);
+                        }
+                        iesire.append("\n");
+                    } catch (const std::runtime_error& e) {
+                        iesire.append("Eroare: ");
+                        iesire.append(e.what());
+                        iesire.append("\n");
+                    }
+                }
+            }
+            const auto durata = std::chrono::steady_clock::now() - start;
+            latente.adauga(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(durata).count()));
+        }
+        return latente;
+    }
+
+private:
+    // "<TAB>nod:raspuns:ns ..." cu raspunsul d/n/i (invalid)/- (lipsa); textul jocului
+    // se reface din ele si din tema cu oop --randeaza (TranscriereJoc::randeaza).
+    template <IesireText Iesire>
+    void scrieEvenimente(Iesire& iesire) const {
+        char separator = '\t';
+        for (const EvenimentJoc& e : transcriere_.evenimente()) {
+            iesire.append(std::string_view(&separator, 1));
+            adaugaNumar(iesire, e.nod);
+            iesire.append(":");
+            iesire.append(LITERE_RASPUNS.substr(static_cast<std::size_t>(e.raspuns), 1));
+            iesire.append(":");
+            adaugaNumar(iesire, e.ns);
+            separator = ' ';
+        }
+    }
+
+};
+
+// -----------------------------------------------------------
+// 7. EXECUTIE CONCURENTA SI SERVER
+// -----------------------------------------------------------
+
+// Pool de fire cu furt de sarcini: fiecare lucrator are coada lui, ia din capatul
+// propriu (LIFO, cache cald) si, cand ramane fara, fura din inceputul cozilor celorlalti.
+class PoolLucratori {
+public:
+    using Sarcina = std::function<void()>;
+
+private:
+    struct Coada {
+        std::mutex mutex;
+        std::deque<Sarcina> sarcini;
+    };
+
+    std::vector<std::unique_ptr<Coada>> cozi_;
+    std::vector<std::thread> fire_;
+    std::mutex mutex_somn_;
+    std::condition_variable cv_somn_;
+    std::condition_variable cv_gata_;
+    std::size_t disponibile_ = 0;       // sarcini din cozi; protejat de mutex_somn_
+    std::size_t neterminate_ = 0;       // trimise si inca nefinalizate; protejat de mutex_somn_
+    std::atomic<std::size_t> urmatoarea_{0};
+    bool oprire_ = false;
+
+    static thread_local const PoolLucratori* pool_curent_;
+    static thread_local std::size_t index_curent_;
+
+    bool extrage(std::size_t index, Sarcina& sarcina) {
+        {
+            Coada& proprie = *cozi_[index];
+            std::lock_guard<std::mutex> lock(proprie.mutex);
+            if (!proprie.sarcini.empty()) {
+                sarcina = std::move(proprie.sarcini.back());
+                proprie.sarcini.pop_back();
+                return true;
+            }
+        }
+        for (std::size_t pas = 1; pas < cozi_.size(); ++pas) {
+            Coada& victima = *cozi_[(index + pas) % cozi_.size()];
+            std::lock_guard<std::mutex> lock(victima.mutex);
+            if (!victima.sarcini.empty()) {
+                sarcina = std::move(victima.sarcini.front());
+                victima.sarcini.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ruleaza(std::size_t index) {
+        pool_curent_ = this;
+        index_curent_ = index;
+        Sarcina sarcina;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_somn_);
+                cv_somn_.wait(lock, [this] { return oprire_ || disponibile_ > 0; });
+                if (disponibile_ == 0) return;  // oprire si nimic de facut
+                --disponibile_;
+            }
+            // Am rezervat o sarcina, deci una exista intr-o coada; o cautam pana o gasim.
+            while (!extrage(index, sarcina)) {
+                std::this_thread::yield();
+            }
+            try {
+                sarcina();
+            } catch (const std::exception& e) {
+                std::cerr << "Eroare in lucrator: " << e.what() << std::endl;
+            }
+            sarcina = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex_somn_);
+                if (--neterminate_ == 0) cv_gata_.notify_all();
+            }
+        }
+    }
+
+public:
+    explicit PoolLucratori(std::size_t numar) {
+        numar = std::max<std::size_t>(numar, 1);
+        for (std::size_t i = 0; i < numar; ++i) {
+            cozi_.push_back(std::make_unique<Coada>());
+        }
+        for (std::size_t i = 0; i < numar; ++i) {
+            fire_.emplace_back([this, i] { ruleaza(i); });
+        }
+    }
+
+    ~PoolLucratori() {
+        asteaptaTerminarea();
+        {
+            std::lock_guard<std::mutex> lock(mutex_somn_);
+            oprire_ = true;
+        }
+        cv_somn_.notify_all();
+        for (auto& fir : fire_) fir.join();
+    }
+
+    PoolLucratori(const PoolLucratori&) = delete;
+    PoolLucratori& operator=(const PoolLucratori&) = delete;
+
+    // Din interiorul unui lucrator sarcina ramane local; din afara se distribuie circular.
+    void trimite(Sarcina sarcina) {
+        const std::size_t index = pool_curent_ == this
+            ? index_curent_
+            : urmatoarea_.fetch_add(1, std::memory_order_relaxed) % cozi_.size();
+        {
+            std::lock_guard<std::mutex> lock(cozi_[index]->mutex);
+            cozi_[index]->sarcini.push_back(std::move(sarcina));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_somn_);
+            ++disponibile_;
+            ++neterminate_;
+        }
+        cv_somn_.notify_one();
+    }
+
+    void asteaptaTerminarea() {
+        std::unique_lock<std::mutex> lock(mutex_somn_);
+        cv_gata_.wait(lock, [this] { return neterminate_ == 0; });
+    }
+
+    std::size_t numarLucratori() const { return fire_.size(); }
+};
+
+inline thread_local const PoolLucratori* PoolLucratori::pool_curent_ = nullptr;
+inline thread_local std::size_t PoolLucratori::index_curent_ = 0;
+
+// Protocolul text al serverului, identic cu fisierul tastatura.txt: cuvinte separate
+// prin spatii, intai tema, apoi raspunsurile; dupa rezultat urmatorul cuvant e o tema
+// noua. Raspunsul serverului este exact transcrierea pe care o scrie ruleazaSilentios.
+//
+// Daca primul cuvant e "GET", conexiunea e o cerere HTTP pentru metrici (GET /metrics
+// in format Prometheus, GET /metrics.json in JSON); restul cererii se ignora.
+class ConexiuneJoc {
+private:
+    enum class Http : std::uint8_t { Nu, AsteaptaCale, Ignora };
+
+    ManagerRaspunsuri manager_;
+    std::string tema_;
+    std::optional<SesiuneJoc> sesiune_;
+    std::optional<DialogInvatare> invatare_;  // dupa o propunere respinsa
+    Http http_ = Http::Nu;
+    // Timpul jocului curent petrecut in procesare, fara asteptarea dupa client.
+    bool masoara_ = false;
+    std::uint64_t ns_parcurgere_ = 0;
+    std::uint64_t ns_iesire_ = 0;
+
+    void terminaJoc() {
+        sesiune_.reset();
+        if (masoara_) {
+            Metrici::timp(FazaTimp::Parcurgere, ns_parcurgere_);
+            Metrici::timp(FazaTimp::Iesire, ns_iesire_);
+        }
+        ns_parcurgere_ = ns_iesire_ = 0;
+    }
+
+    void raspundeHttp(std::string_view cale, std::string& iesire) const {
+        std::string stare = "404 Not Found";
+        std::string tip = "text/plain; charset=utf-8";
+        std::string corp = "Negasit\n";
+#if AKINATOR_METRICI
+        if (cale == "/metrics" || cale == "/metrics.json") {
+            std::ostringstream os;
+            const bool ca_json = cale == "/metrics.json";
+            scrieMetrici(os, manager_, ca_json ? FormatMetrici::JSON : FormatMetrici::Prometheus);
+            stare = "200 OK";
+            tip = ca_json ? "application/json" : "text/plain; version=0.0.4; charset=utf-8";
+            corp = std::move(os).str();
+        }
+#else
+        (void)cale;
+        corp = "Metrici dezactivate la compilare\n";
+#endif
+        iesire.append("HTTP/1.0 ").append(stare).append("\r\nContent-Type: ").append(tip)
+              .append("\r\nContent-Length: ").append(std::to_string(corp.size()))
+              .append("\r\nConnection: close\r\n\r\n").append(corp);
+    }
+
+    void scrieUrmatorul(std::string& iesire) {
+        const Cronometru cronometru(masoara_);
+        switch (sesiune_->stare()) {
+            case SesiuneJoc::Stare::Intrebare:
+                iesire.append("Intrebare: ").append(sesiune_->intrebare()).append(" (da/nu)?\n");
+                break;
+            case SesiuneJoc::Stare::Ghicire:
+                iesire.append("M-am gandit la: ").append(sesiune_->propunere().nume).append(". E corect (da/nu)?\n");
+                break;
+            case SesiuneJoc::Stare::Ghicit:
+                iesire.append(sesiune_->propunere().nume).append("\n");
+                break;
+            case SesiuneJoc::Stare::Negasit:
+                iesire.append("Negasit\n");
+                if (sesiune_->aGresit()) {
+                    invatare_.emplace(sesiune_->cale(), sesiune_->propunere().nume);
+                    invatare_->scrieIntrebarea(iesire);
+                }
+                break;
+        }
+        ns_iesire_ += cronometru.ns();
+        if (sesiune_->terminata()) terminaJoc();
+    }
+
+    void continuaInvatarea(std::string_view cuvant, std::string& iesire) {
+        if (!invatare_->primeste(cuvant)) iesire.append("Raspuns invalid. Incearca 'da' sau 'nu'.\n");
+        if (invatare_->pas() == DialogInvatare::Pas::Gata) {
+            try {
+                manager_.invata(tema_, invatare_->lectie());
+                iesire.append("Am invatat: ").append(invatare_->lectie().nume).append("\n");
+            } catch (const std::runtime_error& e) {
+                iesire.append("Eroare: ").append(e.what()).append("\n");
+            }
+        } else if (!invatare_->inCamp()) {
+            invatare_->scrieIntrebarea(iesire);
+        }
+        if (invatare_->terminat()) invatare_.reset();
+    }
+
+public:
+    explicit ConexiuneJoc(ManagerRaspunsuri manager) : manager_(std::move(manager)) {}
+
+    void primeste(std::string_view cuvant, std::string& iesire) {
+        if (http_ == Http::Ignora) return;
+        if (http_ == Http::AsteaptaCale) {
+            raspundeHttp(cuvant, iesire);
+            http_ = Http::Ignora;
+            return;
+        }
+        if (invatare_) {
+            // Alt cuvant decat da/nu la oferta de invatare e tema jocului urmator.
+            if (invatare_->pas() != DialogInvatare::Pas::Confirmare || cuvant == "da" || cuvant == "nu") {
+                continuaInvatarea(cuvant, iesire);
+                return;
+            }
+            invatare_.reset();
+        }
+
+        if (!sesiune_) {
+            if (cuvant == "GET") {
+                http_ = Http::AsteaptaCale;
+                return;
+            }
+            masoara_ = Metrici::esantion(FazaTimp::Parcurgere);
+        }
+        const Cronometru cronometru(masoara_);
+        if (!sesiune_) {
+            try {
+                tema_.assign(cuvant);
+                manager_.selecteazaTema(tema_);
+            } catch (const std::runtime_error& e) {
+                iesire.append("Eroare: ").append(e.what()).append("\n");
+                return;
+            }
+            sesiune_.emplace(manager_.getSnapshotCurent());
+        } else if (!sesiune_->raspunde(cuvant)) {
+            iesire.append("Raspuns invalid. Incearca 'da' sau 'nu'.\n");
+        }
+        ns_parcurgere_ += cronometru.ns();
+        scrieUrmatorul(iesire);
+    }
+};
+
+// Checkpoint periodic pe un fir propriu (ManagerRaspunsuri::checkpoint), ca scrierea
+// unui arbore mare sa nu intarzie nici jocurile, nici bucla serverului. La oprire se
+// mai face unul, ca lectiile primite intre timp sa nu ramana doar in jurnal.
+class CheckpointPeriodic {
+private:
+    ManagerRaspunsuri manager_;
+    std::chrono::seconds interval_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool oprire_ = false;  // protejat de mutex_
+    std::thread fir_;      // ultimul membru: porneste dupa ce restul e construit
+
+public:
+    CheckpointPeriodic(ManagerRaspunsuri manager, std::chrono::seconds interval) :
+        manager_(std::move(manager)),
+        interval_(interval),
+        fir_([this] {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!cv_.wait_for(lock, interval_, [this] { return oprire_; })) {
+                lock.unlock();
+                manager_.checkpoint();
+                lock.lock();
+            }
+            lock.unlock();
+            manager_.checkpoint();
+        }) {}
+
+    ~CheckpointPeriodic() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            oprire_ = true;
+        }
+        cv_.notify_one();
+        fir_.join();
+    }
+
+    CheckpointPeriodic(const CheckpointPeriodic&) = delete;
+    CheckpointPeriodic& operator=(const CheckpointPeriodic&) = delete;
+};
+
+#if AKINATOR_POSIX
+inline volatile std::sig_atomic_t semnal_oprire = 0;
+
+// Server TCP local pentru teste de incarcare. Un fir reactor (poll) citeste de pe
+// toate conexiunile; cand o conexiune are cuvinte complete, o singura sarcina pe
+// conexiune le proceseaza in pool. Niciun fir nu asteapta dupa un client: sarcina
+// pune raspunsul in coada conexiunii si trimite cat accepta socket-ul, iar restul il
+// trimite reactorul la POLLOUT. Parcurgerea arborilor nu ia niciun lock: fiecare
+// sesiune tine propriul snapshot.
+class ServerJoc {
+private:
+    // Peste LIMITA_INTRARE octeti neprocesati sau LIMITA_IESIRE octeti netrimisi
+    // conexiunea nu mai e citita (si nici procesata, pentru iesire) pana nu se
+    // elibereaza; un singur cuvant mai lung decat LIMITA_INTRARE inchide conexiunea.
+    // O sarcina proceseaza cel mult BUCATA octeti de intrare inainte sa-si puna
+    // raspunsul in coada, ca limitele sa se vada si in timpul procesarii.
+    static constexpr std::size_t LIMITA_INTRARE = 1U << 20;
+    static constexpr std::size_t LIMITA_IESIRE = 1U << 20;
+    static constexpr std::size_t BUCATA = 64U << 10;
+
+    struct Conexiune {
+        int fd;
+        ConexiuneJoc joc;
+        std::mutex mutex;
+        std::string intrare;       // protejat de mutex
+        std::string iesire;        // raspuns inca netrimis; protejat de mutex
+        bool ocupata = false;      // o sarcina o proceseaza acum; protejat de mutex
+        bool inchisa = false;      // clientul a inchis scrierea; protejat de mutex
+        bool abandonata = false;   // eroare sau depasire: nu se mai citeste si nu se mai trimite nimic
+
+        Conexiune(int descriptor, const ManagerRaspunsuri& manager) : fd(descriptor), joc(manager) {}
+        ~Conexiune() { ::close(fd); }
+        Conexiune(const Conexiune&) = delete;
+        Conexiune& operator=(const Conexiune&) = delete;
+
+        // Apelat cu mutex luat.
+        bool terminata() const {
+            return abandonata ? !ocupata : inchisa && !ocupata && intrare.empty() && iesire.empty();
+        }
+
+        // Apelat cu mutex luat.
+        void abandoneaza() {
+            abandonata = inchisa = true;
+            intrare.clear();
+            iesire.clear();
+        }
+
+        // Apelat cu mutex luat. Trimite din coada cat accepta socket-ul, fara sa astepte.
+        void goleste() {
+            std::size_t trimis = 0;
+            while (trimis < iesire.size()) {
+                const ssize_t n = ::send(fd, iesire.data() + trimis, iesire.size() - trimis, MSG_NOSIGNAL | MSG_DONTWAIT);
+                if (n < 0 && errno == EINTR) continue;
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                if (n <= 0) {
+                    abandoneaza();  // clientul a plecat; restul raspunsului nu mai conteaza
+                    return;
+                }
+                trimis += static_cast<std::size_t>(n);
+            }
+            iesire.erase(0, trimis);
+        }
+    };
+
+    ManagerRaspunsuri manager_;
+    PoolLucratori pool_;
+    int ascultator_ = -1;
+    // Lucratorii scriu un octet in trezire_[1] cand reactorul trebuie sa reia o
+    // conexiune (raspuns ramas in coada sau sfarsit de flux), ca sa nu astepte poll-ul.
+    int trezire_[2] = {-1, -1};
+    std::map<int, std::shared_ptr<Conexiune>> conexiuni_;
+    std::atomic<bool> reimprospatare_in_curs_{false};
+
+    static bool esteSpatiu(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+    // Ruleaza in pool; cel mult o instanta pe conexiune (ocupata), deci sesiunea nu e partajata.
+    void proceseaza(const std::shared_ptr<Conexiune>& c) {
+        std::string bucata;
+        std::string iesire;
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(c->mutex);
+                if (!iesire.empty() && !c->abandonata) {
+                    c->iesire.append(iesire);
+                    c->goleste();
+                }
+                iesire.clear();
+                std::size_t capat = c->intrare.size();
+                if (!c->inchisa) {
+                    // Ultimul cuvant poate fi inca incomplet: il lasam pentru urmatorul recv.
+                    while (capat > 0 && !esteSpatiu(c->intrare[capat - 1])) --capat;
+                }
+                if (capat > BUCATA) {
+                    const std::size_t spatiu = c->intrare.find_last_of(" \t\n\r", BUCATA);
+                    if (spatiu != std::string::npos) capat = spatiu + 1;
+                }
+                if (capat == 0 || c->abandonata || c->iesire.size() >= LIMITA_IESIRE) {
+                    c->ocupata = false;
+                    if (!c->iesire.empty() || c->inchisa) trezesteReactorul();
+                    return;
+                }
+                bucata.assign(c->intrare, 0, capat);
+                c->intrare.erase(0, capat);
+            }
+
+            std::size_t i = 0;
+            while (i < bucata.size()) {
+                while (i < bucata.size() && esteSpatiu(bucata[i])) ++i;
+                std::size_t j = i;
+                while (j < bucata.size() && !esteSpatiu(bucata[j])) ++j;
+                if (j > i) c->joc.primeste(std::string_view(bucata).substr(i, j - i), iesire);
+                i = j;
+            }
+        }
+    }
+
+    void trezesteReactorul() const {
+        const char octet = 0;
+        (void)!::write(trezire_[1], &octet, 1);  // pipe plin: reactorul oricum va fi trezit
+    }
+
+    // Apelat cu c->mutex luat.
+    void programeaza(const std::shared_ptr<Conexiune>& c) {
+        if (c->ocupata || c->abandonata || c->intrare.empty() || c->iesire.size() >= LIMITA_IESIRE) return;
+        c->ocupata = true;
+        pool_.trimite([this, c] { proceseaza(c); });
+    }
+
+    void accepta() {
+        const int fd = ::accept(ascultator_, nullptr, nullptr);
+        if (fd < 0) return;
+        conexiuni_.emplace(fd, std::make_shared<Conexiune>(fd, manager_));
+    }
+
+    void citeste(const std::shared_ptr<Conexiune>& c) {
+        char buffer[64 * 1024];
+        const ssize_t n = ::recv(c->fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return;
+
+        std::lock_guard<std::mutex> lock(c->mutex);
+        if (n < 0) {
+            c->abandoneaza();
+        } else if (n == 0) {
+            // Sfarsit de flux: ultima sarcina proceseaza si cuvantul ramas neterminat.
+            c->inchisa = true;
+        } else {
+            c->intrare.append(buffer, static_cast<std::size_t>(n));
+            if (c->intrare.size() >= LIMITA_INTRARE && c->intrare.find_first_of(" \t\n\r") == std::string::npos) {
+                c->abandoneaza();
+            }
+        }
+        programeaza(c);
+    }
+
+    void scrie(const std::shared_ptr<Conexiune>& c) {
+        std::lock_guard<std::mutex> lock(c->mutex);
+        c->goleste();
+        programeaza(c);  // sub LIMITA_IESIRE conexiunea poate continua
+    }
+
+    // Reincarcarea unei teme mari dureaza; o face un lucrator, ca bucla sa nu stea.
+    void reimprospateazaInFundal() {
+        if (reimprospatare_in_curs_.exchange(true)) return;
+        pool_.trimite([this] {
+            manager_.reimprospateazaTeme();
+            reimprospatare_in_curs_ = false;
+        });
+    }
+
+public:
+    ServerJoc(ManagerRaspunsuri manager, std::size_t lucratori) :
+        manager_(std::move(manager)), pool_(lucratori) {}
+
+    ~ServerJoc() {
+        pool_.asteaptaTerminarea();
+        if (ascultator_ >= 0) ::close(ascultator_);
+        for (int fd : trezire_) {
+            if (fd >= 0) ::close(fd);
+        }
+    }
+
+    ServerJoc(const ServerJoc&) = delete;
+    ServerJoc& operator=(const ServerJoc&) = delete;
+
+    // Intoarce portul efectiv (util cu port 0).
+    std::uint16_t porneste(std::uint16_t port) {
+        ascultator_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (ascultator_ < 0) throw std::runtime_error("socket() a esuat");
+        const int da = 1;
+        ::setsockopt(ascultator_, SOL_SOCKET, SO_REUSEADDR, &da, sizeof(da));
+        if (::pipe(trezire_) != 0) throw std::runtime_error("pipe() a esuat");
+        for (int fd : trezire_) ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        sockaddr_in adresa{};
+        adresa.sin_family = AF_INET;
+        adresa.sin_port = htons(port);
+        adresa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::bind(ascultator_, reinterpret_cast<sockaddr*>(&adresa), sizeof(adresa)) != 0
+            || ::listen(ascultator_, SOMAXCONN) != 0) {
+            throw std::runtime_error("Portul " + std::to_string(port) + " nu poate fi folosit");
+        }
+        socklen_t lungime = sizeof(adresa);
+        ::getsockname(ascultator_, reinterpret_cast<sockaddr*>(&adresa), &lungime);
+        return ntohs(adresa.sin_port);
+    }
+
+    // Bucla reactorului; se opreste la SIGINT/SIGTERM. Temele modificate pe disc se
+    // republica periodic (in pool) si sunt vazute de jocurile care incep dupa aceea.
+    void ruleaza() {
+        std::vector<pollfd> urmarite;
+        std::vector<std::shared_ptr<Conexiune>> urmarite_conexiuni;
+        auto ultima_reimprospatare = std::chrono::steady_clock::now();
+        while (semnal_oprire == 0) {
+            urmarite.clear();
+            urmarite_conexiuni.clear();
+            urmarite.push_back({ascultator_, POLLIN, 0});
+            urmarite.push_back({trezire_[0], POLLIN, 0});
+            for (auto it = conexiuni_.begin(); it != conexiuni_.end();) {
+                Conexiune& c = *it->second;
+                short evenimente = 0;
+                bool terminata = false;
+                {
+                    std::lock_guard<std::mutex> lock(c.mutex);
+                    terminata = c.terminata();
+                    if (!c.inchisa && c.intrare.size() < LIMITA_INTRARE && c.iesire.size() < LIMITA_IESIRE) {
+                        evenimente |= POLLIN;
+                    }
+                    if (!c.iesire.empty()) evenimente |= POLLOUT;
+                }
+                if (terminata) {
+                    it = conexiuni_.erase(it);  // ultimul shared_ptr inchide descriptorul
+                    continue;
+                }
+                // Fara evenimente (doar asteapta lucratorul): nu urmarim, ca un POLLHUP
+                // sa nu invarta bucla in gol; lucratorul trezeste reactorul cand termina.
+                if (evenimente != 0) {
+                    urmarite.push_back({it->first, evenimente, 0});
+                    urmarite_conexiuni.push_back(it->second);
+                }
+                ++it;
+            }
+            if (::poll(urmarite.data(), urmarite.size(), 200) > 0) {
+                for (std::size_t i = 0; i < urmarite.size(); ++i) {
+                    const pollfd& p = urmarite[i];
+                    if (p.revents == 0) continue;
+                    if (p.fd == ascultator_) {
+                        accepta();
+                    } else if (p.fd == trezire_[0]) {
+                        char gunoi[256];
+                        while (::read(trezire_[0], gunoi, sizeof(gunoi)) > 0) {}
+                    } else {
+                        const std::shared_ptr<Conexiune>& c = urmarite_conexiuni[i - 2];
+                        const short problema = POLLHUP | POLLERR;
+                        if ((p.events & POLLOUT) && (p.revents & (POLLOUT | problema))) scrie(c);
+                        if ((p.events & POLLIN) && (p.revents & (POLLIN | problema))) citeste(c);
+                    }
+                }
+            }
+            if (std::chrono::steady_clock::now() - ultima_reimprospatare > std::chrono::seconds(1)) {
+                reimprospateazaInFundal();
+                ultima_reimprospatare = std::chrono::steady_clock::now();
+            }
+        }
+        conexiuni_.clear();
+        pool_.asteaptaTerminarea();
+    }
+};
+#endif
+
+// -----------------------------------------------------------
+// 8. UNELTE DIN LINIA DE COMANDA
+// -----------------------------------------------------------
+
+// oop --converteste <tema>_arbore.json [<tema>_arbore.akb]
+int convertesteInBinar(const std::string& intrare, std::string iesire) {
+    if (iesire.empty()) {
+        iesire = std::filesystem::path(intrare).replace_extension(".akb").string();
+    }
+    try {
+        ArboreAkinator arbore(std::filesystem::path(intrare).stem().string());
+        arbore.incarcaDinFisier(intrare);
+        if (arbore.numarNoduri() == 0) {
+            std::cerr << "Eroare: " << intrare << " lipseste sau nu contine \"radacina\"." << std::endl;
+            return 1;
+        }
+        arbore.salveazaBinar(iesire);
+
+        // Verificare: citim inapoi ce am scris.
+        ArboreAkinator verificare;
+        verificare.incarcaDinFisierBinar(iesire);
+        std::cout << intrare << " -> " << iesire << " (" << verificare.numarNoduri() << " noduri, adancime "
+                  << verificare.calculeazaAdancime() << ")\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Eroare: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// oop --analizeaza <fisier.json | fisier.akb>
+// Statisticile arborelui dintr-o singura parcurgere; histograma pe niveluri comprima
+// nivelurile consecutive cu aceleasi numere (un lant de un milion de niveluri da o linie).
+int analizeazaArbore(const std::string& fisier) {
+    try {
+        ArboreAkinator arbore(std::filesystem::path(fisier).stem().string());
+        const auto start = std::chrono::steady_clock::now();
+        if (std::filesystem::path(fisier).extension() == ".akb") {
+            arbore.incarcaDinFisierBinar(fisier);
+        } else {
+            arbore.incarcaDinFisier(fisier);
+        }
+        const auto incarcat = std::chrono::steady_clock::now();
+        const StatisticiArbore s = arbore.statistici();
+        const auto masurat = std::chrono::steady_clock::now();
+        if (s.noduri == 0) {
+            std::cerr << "Eroare: " << fisier << " lipseste sau nu contine \"radacina\"." << std::endl;
+            return 1;
+        }
+
+        auto ms = [](auto durata) { return std::chrono::duration<double, std::milli>(durata).count(); };
+        std::cout << fisier << ": " << s.noduri << " noduri, " << s.frunze << " frunze, adancime " << s.adancime
+                  << ", adancime medie a frunzelor " << s.adancimeMedieFrunze() << "\n"
+                  << "incarcare " << ms(incarcat - start) << " ms, statistici " << ms(masurat - incarcat) << " ms\n"
+                  << "nivel\tnoduri\tfrunze\n";
+        for (std::size_t i = 0; i < s.adancime;) {
+            std::size_t j = i + 1;
+            while (j < s.adancime && s.noduri_pe_nivel[j] == s.noduri_pe_nivel[i] && s.frunze_pe_nivel[j] == s.frunze_pe_nivel[i]) ++j;
+            std::cout << (i + 1);
+            if (j - i > 1) std::cout << '-' << j;
+            std::cout << '\t' << s.noduri_pe_nivel[i] << '\t' << s.frunze_pe_nivel[i] << '\n';
+            i = j;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Eroare: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// --metrici <fisier>: la final (--lot) sau la oprire (--server) se scriu contoarele
+// si histogramele de timp; .json => JSON, altfel formatul text Prometheus.
+int scrieFisierMetrici(const std::string& fisier, const ManagerRaspunsuri& manager) {
+    if (fisier.empty()) return 0;
+#if AKINATOR_METRICI
+    try {
+        scrieMetriciInFisier(fisier, manager);
+    } catch (const std::exception& e) {
+        std::cerr << "Eroare: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+#else
+    (void)manager;
+    std::cerr << "Eroare: programul a fost compilat fara metrici (ENABLE_METRICS=OFF)." << std::endl;
+    return 1;
+#endif
+}
+
+// oop --lot <sesiuni.txt | -> [--transcriere | --evenimente] [--lucratori N] [--metrici <fisier>]
+// Cu mai multi lucratori, sesiunile se trimit in pool in loturi; fiecare lot se scrie
+// intreg cand se termina, deci liniile pot iesi in alta ordine (sunt numerotate).
+int ruleazaModLot(const std::string& sursa, FormatLot format, std::size_t lucratori, const std::string& metrici) {
+    std::ifstream fisier;
+    if (sursa != "-") {
+        fisier.open(sursa);
+        if (!fisier.is_open()) {
+            std::cerr << "Eroare: nu se poate deschide " << sursa << std::endl;
+            return 1;
+        }
+    }
+    std::istream& sesiuni = sursa == "-" ? std::cin : fisier;
+
+    // Temele se incarca in paralel cat timp se citesc primele sesiuni.
+    const ManagerRaspunsuri manager(RegistruTeme::pentru({}, ModIncarcare::Paralel));
+    HistogramaTimp latente;
+    IesireStdout iesire;
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t fire = 1;
+
+    if (lucratori <= 1) {
+        JocAkinator joc(manager);
+        latente = joc.ruleazaLot(sesiuni, iesire, format, 1);
+    } else {
+        constexpr std::size_t SESIUNI_PE_LOT = 4096;
+        const std::size_t maxim_in_zbor = 4 * lucratori;  // memorie marginita si pentru intrari uriase
+
+        PoolLucratori pool(lucratori);
+        fire = pool.numarLucratori();
+        std::mutex mutex_iesire;
+        std::mutex mutex_zbor;
+        std::condition_variable cv_zbor;
+        std::size_t in_zbor = 0;
+
+        auto trimiteLot = [&](std::string lot, std::uint64_t primul) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_zbor);
+                cv_zbor.wait(lock, [&] { return in_zbor < maxim_in_zbor; });
+                ++in_zbor;
+            }
+            pool.trimite([&, lot = std::move(lot), primul] {
+                JocAkinator joc(manager);
+                FluxText is(lot);
+                std::string rezultat;
+                const HistogramaTimp partial = joc.ruleazaLot(is, rezultat, format, primul);
+                {
+                    std::lock_guard<std::mutex> lock(mutex_iesire);
+                    iesire.append(rezultat);
+                    latente.combina(partial);
+                }
+                std::lock_guard<std::mutex> lock(mutex_zbor);
+                --in_zbor;
+                cv_zbor.notify_one();
+            });
+        };
+
+        std::string linie;
+        std::string lot;
+        std::uint64_t numar = 0;
+        std::uint64_t primul = 1;
+        std::size_t in_lot = 0;
+        while (std::getline(sesiuni, linie)) {
+            if (linie.empty() || linie[0] == '#') continue;
+            lot.append(linie).push_back('\n');
+            ++numar;
+            if (++in_lot == SESIUNI_PE_LOT) {
+                trimiteLot(std::move(lot), primul);
+                lot.clear();
+                in_lot = 0;
+                primul = numar + 1;
+            }
+        }
+        if (in_lot > 0) trimiteLot(std::move(lot), primul);
+        pool.asteaptaTerminarea();
+    }
+
+    iesire.goleste();
+    const std::chrono::duration<double> durata = std::chrono::steady_clock::now() - start;
+
+    const double secunde = durata.count();
+    std::cerr << "jocuri: " << latente.total()
+              << ", lucratori: " << fire
+              << ", durata: " << secunde << " s"
+              << ", jocuri/s: " << (secunde > 0 ? static_cast<double>(latente.total()) / secunde : 0.0)
+              << "\nlatenta (ns): medie " << latente.medieNs()
+              << ", p50 " << latente.percentila(0.50)
+              << ", p90 " << latente.percentila(0.90)
+              << ", p99 " << latente.percentila(0.99)
+              << ", max " << latente.maximNs() << std::endl;
+    return scrieFisierMetrici(metrici, manager);
+}
+
+// Inversul lui JocAkinator::scrieEvenimente: "nod:raspuns:ns ..." pentru un arbore cu
+// `noduri` noduri.
+inline void citesteEvenimente(std::string_view text, std::size_t noduri, std::vector<EvenimentJoc>& evenimente) {
+    evenimente.clear();
+    while (!text.empty()) {
+        const std::size_t capat = std::min(text.find(' '), text.size());
+        const std::string_view camp = text.substr(0, capat);
+        text.remove_prefix(std::min(capat + 1, text.size()));
+        if (camp.empty()) continue;
+
+        EvenimentJoc e{};
+        const char* p = camp.data();
+        const char* sfarsit = camp.data() + camp.size();
+        auto [dupa_nod, eroare_nod] = std::from_chars(p, sfarsit, e.nod);
+        const std::size_t litera = dupa_nod + 2 < sfarsit && *dupa_nod == ':' && dupa_nod[2] == ':'
+            ? LITERE_RASPUNS.find(dupa_nod[1]) : std::string_view::npos;
+        if (eroare_nod != std::errc{} || litera == std::string_view::npos
+            || std::from_chars(dupa_nod + 3, sfarsit, e.ns).ptr != sfarsit) {
+            throw std::runtime_error("eveniment invalid '" + std::string(camp) + "'");
+        }
+        if (e.nod >= noduri) {
+            throw std::runtime_error("nodul " + std::to_string(e.nod) + " nu exista in tema (alt arbore decat la inregistrare?)");
+        }
+        e.raspuns = static_cast<RaspunsJucator>(litera);
+        evenimente.push_back(e);
+    }
+}
+
+// oop --randeaza <evenimente.txt | ->
+// Reface din iesirea lui --lot ... --evenimente textul jocurilor, exact ca --lot ...
+// --transcriere. Nodurile sunt indici in arborele temei, deci tema trebuie sa fie cea
+// de la inregistrare: o lectie invatata intre timp face din frunza ei o intrebare.
+// Dialogul de invatare nu e in evenimente, deci nu apare.
+int randeazaEvenimente(const std::string& sursa) {
+    std::ifstream fisier;
+    if (sursa != "-") {
+        fisier.open(sursa);
+        if (!fisier.is_open()) {
+            std::cerr << "Eroare: nu se poate deschide " << sursa << std::endl;
+            return 1;
+        }
+    }
+    std::istream& intrare = sursa == "-" ? std::cin : fisier;
+
+    ManagerRaspunsuri manager;
+    IesireStdout iesire;
+    std::vector<EvenimentJoc> evenimente;
+    std::string linie;
+    std::size_t numar_linie = 0;
+    int cod = 0;
+    while (std::getline(intrare, linie)) {
+        ++numar_linie;
+        // nr, tema, rezultat, evenimente (daca au fost), "invatat: ..." (daca a fost)
+        std::array<std::string_view, 4> campuri{};
+        std::size_t numar_campuri = 0;
+        for (std::string_view rest = linie; numar_campuri < campuri.size();) {
+            const std::size_t tab = rest.find('\t');
+            campuri[numar_campuri++] = rest.substr(0, tab);
+            if (tab == std::string_view::npos) break;
+            rest.remove_prefix(tab + 1);
+        }
+        try {
+            if (numar_campuri < 3) throw std::runtime_error("se asteapta nr<TAB>tema<TAB>rezultat");
+            const std::string_view rezultat = campuri[2];
+            if (campuri[1] == "-") {
+                iesire.append("Eroare: Nu s-a putut citi tema din fisier.\n\n");
+                continue;
+            }
+            if (rezultat.starts_with("Eroare: ")) {
+                iesire.append(rezultat);
+                iesire.append("\n\n");
+                continue;
+            }
+            manager.selecteazaTema(std::string(campuri[1]));
+            const ArboreAkinator& arbore = *manager.getArboreCurent();
+            citesteEvenimente(numar_campuri > 3 && !campuri[3].starts_with("invatat: ") ? campuri[3] : std::string_view{},
+                              arbore.numarNoduri(), evenimente);
+            TranscriereJoc::randeaza(arbore, evenimente, iesire);
+            iesire.append(rezultat);
+            iesire.append("\n\n");
+        } catch (const std::runtime_error& e) {
+            iesire.goleste();
+            std::cerr << "Eroare la linia " << numar_linie << ": " << e.what() << std::endl;
+            cod = 1;
+        }
+    }
+    iesire.goleste();
+    return cod;
+}
+
+// oop --invata <tema> <cale> <nume> <domeniu> <tip> <intrebare> <da|nu>
+int invataDinLiniaDeComanda(const std::vector<std::string>& argumente) {
+    const Lectie lectie{argumente[2], argumente[3], argumente[4], argumente[5], argumente[6], argumente[7] == "da"};
+    if (argumente[7] != "da" && argumente[7] != "nu") {
+        std::cerr << "Eroare: raspunsul pentru entitatea noua trebuie sa fie 'da' sau 'nu'." << std::endl;
+        return 1;
+    }
+    try {
+        ManagerRaspunsuri manager;
+        manager.selecteazaTema(argumente[1]);
+        if (manager.getArboreCurent()->contineEntitatea(lectie.nume)) {
+            std::cerr << "Atentie: " << lectie.nume << " exista deja in tema " << argumente[1]
+                      << " (vezi oop --cauta); se adauga inca o frunza." << std::endl;
+        }
+        manager.invata(argumente[1], lectie);
+        manager.selecteazaTema(argumente[1]);
+        std::cout << "Invatat: " << lectie.nume << " (" << argumente[1] << ", "
+                  << manager.getArboreCurent()->numarNoduri() << " noduri)\n";
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Eroare: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// oop --checkpoint <tema>
+// Muta lectiile din jurnalul temei in fisierul ei de baza si compacteaza jurnalul.
+// Merge si cu serverul pornit: acesta preia noul fisier la urmatoarea reimprospatare.
+int checkpointTema(const std::string& tema) {
+    try {
+        ManagerRaspunsuri manager;
+        if (!manager.checkpoint(tema)) {
+            std::cout << tema << ": jurnalul e gol, nimic de salvat\n";
+            return 0;
+        }
+        manager.selecteazaTema(tema);
+        std::cout << tema << ": salvat (" << manager.getArboreCurent()->numarNoduri() << " noduri), jurnal compactat\n";
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Eroare: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// oop --cauta <tema> <nume>
+// Frunzele cu numele dat, comparat fara diacritice si majuscule ("franta" gaseste
+// "Franța"), cu intrebarile si raspunsurile care duc la fiecare (si calea d/n pentru
+// --invata). Daca numele nu exista, se afiseaza numele care incep asa si se iese cu 1.
+int cautaEntitate(const std::string& tema, const std::string& nume) {
+    constexpr std::size_t SUGESTII = 10;
+    ManagerRaspunsuri manager;
+    try {
+        manager.selecteazaTema(tema);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Eroare: " << e.what() << std::endl;
+        return 1;
+    }
+    const auto arbore = manager.getSnapshotCurent();
+    const std::span<const IndexNod> frunze = arbore->index().frunze(nume);
+    if (frunze.empty()) {
+        std::cout << nume << ": nu exista in tema " << tema << " (" << arbore->index().numarNume() << " nume distincte)\n";
+        const std::vector<IndexNod> sugestii = arbore->index().cautaDupaPrefix(nume, SUGESTII);
+        if (!sugestii.empty()) {
+            std::cout << "Nume care incep asa:\n";
+            for (const IndexNod f : sugestii) std::cout << "  " << arbore->text(f) << "\n";
+        }
+        return 1;
+    }
+    for (const IndexNod f : frunze) {
+        const std::vector<PasDrum> drum = arbore->drumSpre(f);
+        std::string cale;
+        for (const PasDrum& pas : drum) cale += pas.da ? 'd' : 'n';
+        std::cout << arbore->text(f) << " (cale " << cale << ")\n";
+        for (const PasDrum& pas : drum) {
+            std::cout << "  " << arbore->text(pas.nod) << " " << (pas.da ? "da" : "nu") << "\n";
+        }
+    }
+    return 0;
+}
+
+// oop --simuleaza <tema> [--zgomot p]
+// Joaca pentru fiecare entitate din tema cate un joc cu ambele motoare, cu un jucator
+// simulat care raspunde conform drumului entitatii in arbore, gresind cu probabilitatea
+// p, si la intamplare la intrebarile fara raspuns cunoscut.
+int simuleazaMotoare(const std::string& tema, double zgomot) {
+    ManagerRaspunsuri manager;
+    try {
+        manager.selecteazaTema(tema);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Eroare: " << e.what() << std::endl;
+        return 1;
+    }
+    const auto arbore = manager.getSnapshotCurent();
+    const MotorProbabilist motor(arbore);
+    std::unordered_map<std::string_view, std::uint32_t> id_intrebare;
+    for (std::uint32_t q = 0; q < motor.numarIntrebari(); ++q) id_intrebare.emplace(motor.intrebare(q), q);
+
+    std::mt19937 generator(12345);
+    std::bernoulli_distribution greseste(zgomot);
+    std::bernoulli_distribution banut(0.5);
+    auto raspunsJucator = [&](std::uint32_t e, std::uint32_t q) {
+        const int cunoscut = motor.raspunsCunoscut(e, q);
+        const bool da = cunoscut < 0 ? banut(generator) : cunoscut == 1;
+        return greseste(generator) ? !da : da;
+    };
+
+    std::size_t corect_arbore = 0, intrebari_arbore = 0;
+    std::size_t corect_probabilist = 0, intrebari_probabilist = 0, ghiciri_probabilist = 0;
+    HistogramaTimp alegere;
+    const std::size_t entitati = motor.numarEntitati();
+
+    for (std::uint32_t e = 0; e < entitati; ++e) {
+        const std::string_view nume = motor.entitate(e).nume;
+
+        SesiuneJoc sesiune(*arbore);
+        while (sesiune.stare() == SesiuneJoc::Stare::Intrebare) {
+            sesiune.raspunde(raspunsJucator(e, id_intrebare.at(sesiune.intrebare())) ? "da" : "nu");
+            ++intrebari_arbore;
+        }
+        if (sesiune.stare() == SesiuneJoc::Stare::Ghicire && sesiune.propunere().nume == nume) ++corect_arbore;
+
+        SesiuneProbabilista probabilist(motor);
+        for (int ghiciri = 0; ghiciri < SesiuneProbabilista::PROPUNERI_MAXIME; ++ghiciri) {
+            for (;;) {
+                const auto start = std::chrono::steady_clock::now();
+                const auto q = probabilist.urmatoareaIntrebare();
+                alegere.adauga(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count()));
+                if (!q) break;
+                probabilist.raspunde(*q, raspunsJucator(e, *q) ? SesiuneProbabilista::Raspuns::Da : SesiuneProbabilista::Raspuns::Nu);
+            }
+            const auto favorit = probabilist.celMaiProbabil();
+            if (!favorit) break;
+            ++ghiciri_probabilist;
+            if (motor.entitate(*favorit).nume == nume) {
+                ++corect_probabilist;
+                break;
+            }
+            probabilist.respinge(*favorit);
+        }
+        intrebari_probabilist += probabilist.intrebariPuse();
+    }
+
+    auto procent = [&](std::size_t x) { return entitati ? 100.0 * static_cast<double>(x) / static_cast<double>(entitati) : 0.0; };
+    auto medie = [&](std::size_t x) { return entitati ? static_cast<double>(x) / static_cast<double>(entitati) : 0.0; };
+    std::cout << "tema: " << tema << ", entitati: " << entitati << ", intrebari: " << motor.numarIntrebari()
+              << ", zgomot: " << zgomot << "\n"
+              << "arbore:      corect " << procent(corect_arbore) << "%, intrebari/joc " << medie(intrebari_arbore) << "\n"
+              << "probabilist: corect " << procent(corect_probabilist) << "%, intrebari/joc " << medie(intrebari_probabilist)
+              << ", propuneri/joc " << medie(ghiciri_probabilist) << "\n"
+              << "alegerea intrebarii (ns): medie " << alegere.medieNs() << ", p50 " << alegere.percentila(0.5)
+              << ", p99 " << alegere.percentila(0.99) << ", max " << alegere.maximNs() << "\n";
+    return 0;
+}
+
+// Rejoaca raspunsurile unei sesiuni jucate cu --probabilist (dupa tema), exact ca
+// JocAkinator::ruleazaProbabilist: motorul e determinist, deci pune aceleasi intrebari.
+// Intoarce entitatea confirmata si adauga in raspunsuri perechile (intrebare, da).
+std::optional<std::uint32_t> rejoacaSesiuneProbabilista(const MotorProbabilist& motor, std::istream& is,
+                                                        std::vector<std::pair<std::uint32_t, bool>>& raspunsuri) {
+    SesiuneProbabilista sesiune(motor);
+    std::string raspuns;
+    for (int ghiciri = 0; ghiciri < SesiuneProbabilista::PROPUNERI_MAXIME; ++ghiciri) {
+        while (const auto q = sesiune.urmatoareaIntrebare()) {
+            if (!(is >> raspuns)) return std::nullopt;
+            if (raspuns == "da" || raspuns == "nu") {
+                raspunsuri.emplace_back(*q, raspuns == "da");
+                sesiune.raspunde(*q, raspuns == "da" ? SesiuneProbabilista::Raspuns::Da : SesiuneProbabilista::Raspuns::Nu);
+            } else {
+                sesiune.raspunde(*q, SesiuneProbabilista::Raspuns::NuStiu);
+            }
+        }
+        const auto favorit = sesiune.celMaiProbabil();
+        if (!favorit || !(is >> raspuns)) return std::nullopt;
+        if (raspuns == "da") return favorit;
+        sesiune.respinge(*favorit);
+    }
+    return std::nullopt;
+}
+
+// oop --optimizeaza <tema> [--statistici <sesiuni.txt> [--probabilist]] [--iesire <fisier.json>]
+// Statisticile sunt sesiuni inregistrate (formatul de la --lot). Fiecare sesiune a temei
+// terminata cu o entitate numara o aparitie a ei; ponderea e 1 + aparitiile, ca si
+// entitatile nevazute sa conteze putin. Sesiunile jucate cu --probabilist dau in plus
+// raspunsurile jucatorilor la intrebari din afara drumului entitatii in arbore; pentru
+// fiecare pereche (entitate, intrebare) se pastreaza raspunsul majoritar.
+int optimizeazaTema(const std::string& tema, const std::string& statistici, bool probabilist, std::string iesire) {
+    if (iesire.empty()) iesire = tema + "_arbore.optimizat.json";
+
+    ManagerRaspunsuri manager;
+    try {
+        manager.selecteazaTema(tema);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Eroare: " << e.what() << std::endl;
+        return 1;
+    }
+    const auto arbore = manager.getSnapshotCurent();
+    if (arbore->radacina() == NOD_NUL) {
+        std::cerr << "Eroare: tema " << tema << " nu are niciun arbore incarcat." << std::endl;
+        return 1;
+    }
+
+    const MotorProbabilist motor_joc(arbore);
+    std::unordered_map<std::string_view, double> frecvente;
+    std::map<std::pair<std::uint32_t, std::uint32_t>, std::array<std::uint32_t, 2>> voturi;  // (entitate, intrebare) -> {nu, da}
+    std::size_t sesiuni = 0;
+    if (!statistici.empty()) {
+        std::ifstream f(statistici);
+        if (!f.is_open()) {
+            std::cerr << "Eroare: nu se poate deschide " << statistici << std::endl;
+            return 1;
+        }
+        std::string linie;
+        std::string cuvant;
+        std::vector<std::pair<std::uint32_t, bool>> raspunsuri;
+        while (std::getline(f, linie)) {
+            std::istringstream is(linie);
+            if (!(is >> cuvant) || cuvant != tema) continue;
+            if (probabilist) {
+                raspunsuri.clear();
+                const auto confirmata = rejoacaSesiuneProbabilista(motor_joc, is, raspunsuri);
+                if (!confirmata) continue;
+                frecvente[motor_joc.entitate(*confirmata).nume] += 1.0;
+                for (const auto& [q, da] : raspunsuri) ++voturi[{*confirmata, q}][da ? 1 : 0];
+            } else {
+                SesiuneJoc sesiune(*arbore);
+                while (!sesiune.terminata() && is >> cuvant) sesiune.raspunde(cuvant);
+                const bool gasit = sesiune.stare() == SesiuneJoc::Stare::Ghicire || sesiune.stare() == SesiuneJoc::Stare::Ghicit;
+                if (!gasit) continue;
+                frecvente[sesiune.propunere().nume] += 1.0;
+            }
+            ++sesiuni;
+        }
+    }
+
+    std::vector<Observatie> observatii;
+    for (const auto& [cheie, v] : voturi) {
+        if (v[0] == v[1]) continue;
+        observatii.push_back({std::string(motor_joc.entitate(cheie.first).nume),
+                              std::string(motor_joc.intrebare(cheie.second)), v[1] > v[0]});
+    }
+    for (auto& [nume, f] : frecvente) f += 1.0;
+
+    const MotorProbabilist motor(arbore, observatii);
+    std::vector<double> pondere(motor.numarEntitati());
+    for (std::uint32_t e = 0; e < pondere.size(); ++e) {
+        const auto it = frecvente.find(motor.entitate(e).nume);
+        pondere[e] = it != frecvente.end() ? it->second : 1.0;
+    }
+
+    try {
+        OptimizatorArbore optimizator(motor, std::move(pondere));
+        const ArboreAkinator optimizat = optimizator.construieste();
+        const CostArbore inainte = masoaraArbore(*arbore, frecvente);
+        const CostArbore dupa = masoaraArbore(optimizat, frecvente);
+
+        auto raport = [](const char* eticheta, const CostArbore& c, std::size_t noduri) {
+            std::cout << eticheta << "intrebari/joc " << c.medie << " (ponderat " << c.medie_ponderata
+                      << "), maxim " << c.maxim << ", entitati " << c.entitati << ", noduri " << noduri << "\n";
+        };
+        std::cout << "tema: " << tema << ", sesiuni folosite: " << sesiuni
+                  << ", raspunsuri observate: " << observatii.size() << "\n";
+        raport("inainte: ", inainte, arbore->numarNoduri());
+        raport("dupa:    ", dupa, optimizat.numarNoduri());
+        if (optimizator.ramificariIncomplete() > 0) {
+            std::cout << optimizator.ramificariIncomplete()
+                      << " intrebari nu au raspuns cunoscut pentru toate entitatile; acestea apar pe ambele ramuri\n";
+        }
+        if (dupa.medie_ponderata >= inainte.medie_ponderata && dupa.maxim >= inainte.maxim) {
+            std::cout << "Arborele existent este deja cel putin la fel de bun; nu s-a scris nimic.\n";
+            return 0;
+        }
+
+        optimizat.salveazaJSON(iesire);
+        // Verificare: citim inapoi ce am scris.
+        ArboreAkinator verificare(tema);
+        verificare.incarcaDinFisier(iesire);
+        if (verificare.numarNoduri() != optimizat.numarNoduri()) {
+            std::cerr << "Eroare: " << iesire << " nu se citeste inapoi identic." << std::endl;
+            return 1;
+        }
+        std::cout << "scris: " << iesire << "\n";
+        const std::string jurnal = tema + "_arbore.jurnal";
+        if (std::filesystem::exists(jurnal)) {
+            std::cout << "Lectiile din " << jurnal << " sunt incluse; la inlocuirea temei, jurnalul trebuie sters.\n";
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Eroare: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// oop --genereaza <echilibrat|lant|aleator> <entitati> [--asimetrie a] [--adancime-maxima D]
+//               [--samanta s] [--iesire <fisier.json>]
+// Tema arborelui e numele fisierului fara "_arbore.json" (implicit sintetic_arbore.json).
+int genereazaArbore(const ParametriGenerare& parametri, std::string iesire) {
+    if (iesire.empty()) iesire = "sintetic_arbore.json";
+    std::string tema = std::filesystem::path(iesire).stem().string();
+    if (tema.ends_with("_arbore")) tema.resize(tema.size() - std::string_view("_arbore").size());
+    try {
+        GeneratorArbore generator(parametri);
+        const ArboreAkinator arbore = generator.genereaza(tema);
+        arbore.salveazaJSON(iesire);
+        std::cout << iesire << ": " << parametri.entitati << " entitati, " << arbore.numarNoduri()
+                  << " noduri, adancime " << generator.adancime() << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Eroare: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Timpul unei operatii repetate pana trec macar ~0.2 s (minim 3, maxim 100000 de repetari).
+// Minimul e cel mai stabil intre rulari, deci pe el se compara versiunile.
+template <typename Operatie>
+json masoaraOperatia(Operatie&& operatie) {
+    constexpr std::uint64_t BUGET_NS = 200'000'000;
+    std::uint64_t minim = std::numeric_limits<std::uint64_t>::max();
+    std::uint64_t total = 0;
+    std::size_t repetari = 0;
+    while (repetari < 3 || (total < BUGET_NS && repetari < 100'000)) {
+        const auto start = std::chrono::steady_clock::now();
+        operatie();
+        const auto ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        minim = std::min(minim, ns);
+        total += ns;
+        ++repetari;
+    }
+    return {{"min_ns", minim}, {"medie_ns", static_cast<double>(total) / static_cast<double>(repetari)}, {"repetari", repetari}};
+}
+
+// Un arbore generat, incarcat si jucat in toate felurile pe care le foloseste programul.
+// Fisierele temporare (JSON, .akb) stau in director; tema se numeste "sintetic".
+json masoaraArboreGenerat(const ParametriGenerare& parametri, const std::filesystem::path& director, std::size_t jocuri) {
+    const std::string fisier_json = (director / "sintetic_arbore.json").string();
+    const std::string fisier_binar = (director / "sintetic.akb").string();  // alt nume: managerul sa citeasca JSON-ul
+
+    GeneratorArbore generator(parametri);
+    const auto start = std::chrono::steady_clock::now();
+    const ArboreAkinator generat = generator.genereaza("sintetic");
+    const auto ns_generare = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    generat.salveazaJSON(fisier_json);
+    generat.salveazaBinar(fisier_binar);
+
+    json rezultat = {
+        {"forma", NUME_FORME[static_cast<std::size_t>(parametri.forma)]},
+        {"entitati", parametri.entitati},
+        {"noduri", generat.numarNoduri()},
+        {"adancime", generator.adancime()},
+        {"octeti_json", std::filesystem::file_size(fisier_json)},
+        {"generare_ns", ns_generare},
+    };
+
+    ArboreAkinator arbore("sintetic");
+    rezultat["incarca_json"] = masoaraOperatia([&] { arbore.incarcaDinFisier(fisier_json); });
+    ArboreAkinator dom("sintetic");
+    rezultat["incarca_json_dom"] = masoaraOperatia([&] { dom.incarcaDinFisierDOM(fisier_json); });
+    if (dom.numarNoduri() != arbore.numarNoduri() || dom.calculeazaAdancime() != arbore.calculeazaAdancime()) {
+        throw std::runtime_error("Incarcatorul DOM si cel SAX dau arbori diferiti.");
+    }
+    ArboreAkinator binar("sintetic");
+    rezultat["incarca_akb"] = masoaraOperatia([&] { binar.incarcaDinFisierBinar(fisier_binar); });
+    rezultat["copiaza_arbore"] = masoaraOperatia([&] { const ArboreAkinator copie(arbore); (void)copie; });
+    rezultat["statistici"] = masoaraOperatia([&] { (void)arbore.statistici(); });
+    rezultat["indexeaza"] = masoaraOperatia([&] { arbore.indexeaza(); });
+    rezultat["cauta_entitate"] = masoaraOperatia([&] {
+        for (std::size_t i = 1; i <= 1000; ++i) {
+            if (!arbore.contineEntitatea("entitatea " + std::to_string(i % parametri.entitati + 1))) {
+                throw std::runtime_error("Entitate negasita in index.");
+            }
+        }
+    });
+    rezultat["cauta_entitate"]["operatii_per_repetare"] = 1000;
+
+    std::optional<ManagerRaspunsuri> manager;
+    // Registru nou la fiecare repetare (nu cel partajat), ca sa se masoare si incarcarea temei.
+    rezultat["construieste_manager"] = masoaraOperatia([&] {
+        manager.emplace(std::make_shared<RegistruTeme>(director, ModIncarcare::LaCerere));
+        manager->selecteazaTema("sintetic");
+    });
+    rezultat["selecteaza_tema"] = masoaraOperatia([&] {
+        for (int i = 0; i < 1000; ++i) manager->selecteazaTema("sintetic");
+    });
+    rezultat["selecteaza_tema"]["operatii_per_repetare"] = 1000;
+    rezultat["copiaza_manager"] = masoaraOperatia([&] { const ManagerRaspunsuri copie(*manager); (void)copie; });
+
+    // Jocuri cu raspunsuri aleatoare pana la o frunza, confirmata cu "da".
+    std::mt19937_64 aleator(parametri.samanta);
+    std::bernoulli_distribution banut(0.5);
+    std::vector<std::string> sesiuni(jocuri);
+    std::size_t intrebari = 0;
+    for (std::string& sesiune : sesiuni) {
+        SesiuneJoc joc(arbore);
+        while (joc.stare() == SesiuneJoc::Stare::Intrebare) {
+            const char* raspuns = banut(aleator) ? "da " : "nu ";
+            sesiune += raspuns;
+            joc.raspunde(std::string_view(raspuns, 2));
+            ++intrebari;
+        }
+        sesiune += "da";
+    }
+
+    const ArboreAkinator* curent = manager->getArboreCurent();
+    IesireNula nul;
+    std::istringstream is;
+    HistogramaTimp latente;
+    std::size_t ghicite = 0;
+    const auto start_jocuri = std::chrono::steady_clock::now();
+    for (const std::string& sesiune : sesiuni) {
+        is.clear();
+        is.str(sesiune);
+        const auto start_joc = std::chrono::steady_clock::now();
+        ghicite += curent->determinaEntitatea(is, nul).has_value();
+        latente.adauga(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_joc).count()));
+    }
+    const double secunde = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_jocuri).count();
+    if (ghicite != jocuri) {
+        throw std::runtime_error("Doar " + std::to_string(ghicite) + " din " + std::to_string(jocuri) + " jocuri s-au terminat cu o ghicire.");
+    }
+    rezultat["jocuri"] = {
+        {"numar", jocuri},
+        {"intrebari_medii", jocuri ? static_cast<double>(intrebari) / static_cast<double>(jocuri) : 0.0},
+        {"jocuri_pe_secunda", secunde > 0 ? static_cast<double>(jocuri) / secunde : 0.0},
+        {"medie_ns", latente.medieNs()},
+        {"p50_ns", latente.percentila(0.5)},
+        {"p99_ns", latente.percentila(0.99)},
+        {"max_ns", latente.maximNs()},
+    };
+
+    // Aceleasi jocuri, cu transcrierea scrisa intr-un std::string refolosit; diferenta
+    // fata de medie_ns e costul iesirii pe joc.
+    std::string text;
+    const auto start_text = std::chrono::steady_clock::now();
+    for (const std::string& sesiune : sesiuni) {
+        is.clear();
+        is.str(sesiune);
+        text.clear();
+        curent->determinaEntitatea(is, text);
+    }
+    const double ns_text = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_text).count();
+    rezultat["jocuri"]["cu_transcriere_medie_ns"] = jocuri ? ns_text / static_cast<double>(jocuri) : 0.0;
+    return rezultat;
+}
+
+// oop --benchmark [--entitati 1000,10000,...] [--forme echilibrat,lant,aleator] [--jocuri N] [--iesire <fisier.json>]
+// Rezultatul (JSON) merge in fisier sau pe stdout; pe stderr se scrie un rezumat pe linie.
+int ruleazaBenchmark(const std::vector<std::size_t>& dimensiuni, const std::vector<FormaArbore>& forme,
+                     std::size_t jocuri, const std::string& iesire) {
+    std::error_code ec;
+    const std::filesystem::path director = std::filesystem::temp_directory_path() / ("akinator_benchmark_" + std::to_string(idProces()));
+    std::filesystem::create_directories(director, ec);
+    if (ec) {
+        std::cerr << "Eroare: nu se poate crea " << director << ": " << ec.message() << std::endl;
+        return 1;
+    }
+
+    json rezultate = json::array();
+    int cod = 0;
+    for (const FormaArbore forma : forme) {
+        for (const std::size_t entitati : dimensiuni) {
+            ParametriGenerare parametri;
+            parametri.forma = forma;
+            parametri.entitati = entitati;
+            try {
+                json r = masoaraArboreGenerat(parametri, director, jocuri);
+                std::cerr << r["forma"].get<std::string>() << " " << entitati << ": adancime " << r["adancime"]
+                          << ", incarca_json " << r["incarca_json"]["min_ns"] << " ns"
+                          << " (DOM " << r["incarca_json_dom"]["min_ns"] << " ns)"
+                          << ", incarca_akb " << r["incarca_akb"]["min_ns"] << " ns"
+                          << ", jocuri/s " << r["jocuri"]["jocuri_pe_secunda"]
+                          << ", ns/joc " << r["jocuri"]["medie_ns"] << " (cu transcriere " << r["jocuri"]["cu_transcriere_medie_ns"] << ")" << std::endl;
+                rezultate.push_back(std::move(r));
+            } catch (const std::exception& e) {
+                std::cerr << "Eroare (" << NUME_FORME[static_cast<std::size_t>(forma)] << ", " << entitati << "): " << e.what() << std::endl;
+                cod = 1;
+            }
+        }
+    }
+    std::filesystem::remove_all(director, ec);
+
+#if defined(__OPTIMIZE__) || (defined(_MSC_VER) && !defined(_DEBUG))
+    constexpr bool optimizat = true;
+#else
+    constexpr bool optimizat = false;
+#endif
+#if defined(__VERSION__)
+    const std::string compilator = __VERSION__;
+#elif defined(_MSC_FULL_VER)
+    const std::string compilator = "MSVC " + std::to_string(_MSC_FULL_VER);
+#else
+    const std::string compilator = "necunoscut";
+#endif
+    const json raport = {
+        {"versiune", 1},
+        {"compilator", compilator},
+        {"optimizat", optimizat},
+        {"metrici", static_cast<bool>(AKINATOR_METRICI)},
+        {"rezultate", std::move(rezultate)},
+    };
+    if (iesire.empty()) {
+        std::cout << raport.dump(2) << "\n";
+    } else {
+        std::ofstream f(iesire);
+        f << raport.dump(2) << "\n";
+        if (!f) {
+            std::cerr << "Eroare: nu se poate scrie " << iesire << std::endl;
+            return 1;
+        }
+    }
+    return cod;
+}
+
+// oop --server <port> [--lucratori N] [--metrici <fisier>] [--checkpoint <secunde>]
+// Metricile se pot citi si in timpul rularii, cu GET /metrics pe acelasi port.
+int ruleazaModServer(std::uint16_t port, std::size_t lucratori, const std::string& metrici, std::size_t checkpoint) {
+#if AKINATOR_POSIX
+    std::signal(SIGINT, [](int) { semnal_oprire = 1; });
+    std::signal(SIGTERM, [](int) { semnal_oprire = 1; });
+    try {
+        const ManagerRaspunsuri manager(RegistruTeme::pentru({}, ModIncarcare::Paralel));
+        std::optional<CheckpointPeriodic> checkpointuri;
+        if (checkpoint > 0) checkpointuri.emplace(manager, std::chrono::seconds(checkpoint));
+        ServerJoc server{manager, lucratori};
+        const std::uint16_t efectiv = server.porneste(port);
+        std::cerr << "Server pornit pe 127.0.0.1:" << efectiv << " cu " << lucratori << " lucratori" << std::endl;
+        server.ruleaza();
+        return scrieFisierMetrici(metrici, manager);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Eroare: " << e.what() << std::endl;
+        return 1;
+    }
+#else
+    (void)port;
+    (void)lucratori;
+    (void)metrici;
+    (void)checkpoint;
+    std::cerr << "Eroare: serverul este disponibil doar pe sisteme POSIX." << std::endl;
+    return 1;
+#endif
+}
+
+// -----------------------------------------------------------
+// 9. MAIN FUNCTION
+// -----------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    std::ios_base::sync_with_stdio(false);
+    std::cin.tie(NULL);
+
+    const std::vector<std::string> argumente(argv + 1, argv + argc);
+    const bool probabilist = argumente.size() == 1 && argumente[0] == "--probabilist";
+    if (!argumente.empty() && !probabilist) {
+        if (argumente[0] == "--converteste" && (argumente.size() == 2 || argumente.size() == 3)) {
+            return convertesteInBinar(argumente[1], argumente.size() == 3 ? argumente[2] : "");
+        }
+        if (argumente[0] == "--simuleaza" && (argumente.size() == 2 || (argumente.size() == 4 && argumente[2] == "--zgomot"))) {
+            return simuleazaMotoare(argumente[1], argumente.size() == 4 ? std::strtod(argumente[3].c_str(), nullptr) : 0.0);
+        }
+        if (argumente[0] == "--optimizeaza" && argumente.size() >= 2) {
+            std::string statistici;
+            std::string iesire;
+            bool sesiuni_probabiliste = false;
+            bool valid = true;
+            for (std::size_t i = 2; valid && i < argumente.size(); ++i) {
+                if (argumente[i] == "--probabilist") {
+                    sesiuni_probabiliste = true;
+                } else if (i + 1 >= argumente.size()) {
+                    valid = false;
+                } else if (argumente[i] == "--statistici") {
+                    statistici = argumente[++i];
+                } else if (argumente[i] == "--iesire") {
+                    iesire = argumente[++i];
+                } else {
+                    valid = false;
+                }
+            }
+            if (valid) return optimizeazaTema(argumente[1], statistici, sesiuni_probabiliste, iesire);
+        }
+        if (argumente[0] == "--randeaza" && argumente.size() == 2) {
+            return randeazaEvenimente(argumente[1]);
+        }
+        if (argumente[0] == "--cauta" && argumente.size() == 3) {
+            return cautaEntitate(argumente[1], argumente[2]);
+        }
+        if (argumente[0] == "--analizeaza" && argumente.size() == 2) {
+            return analizeazaArbore(argumente[1]);
+        }
+        if (argumente[0] == "--genereaza" && argumente.size() >= 3) {
+            ParametriGenerare parametri;
+            std::string iesire;
+            const auto forma = formaDinNume(argumente[1]);
+            parametri.entitati = std::strtoull(argumente[2].c_str(), nullptr, 10);
+            bool valid = forma.has_value();
+            for (std::size_t i = 3; valid && i < argumente.size(); ++i) {
+                if (i + 1 >= argumente.size()) {
+                    valid = false;
+                } else if (argumente[i] == "--asimetrie") {
+                    parametri.asimetrie = std::strtod(argumente[++i].c_str(), nullptr);
+                } else if (argumente[i] == "--adancime-maxima") {
+                    parametri.adancime_maxima = std::strtoull(argumente[++i].c_str(), nullptr, 10);
+                } else if (argumente[i] == "--samanta") {
+                    parametri.samanta = std::strtoull(argumente[++i].c_str(), nullptr, 10);
+                } else if (argumente[i] == "--iesire") {
+                    iesire = argumente[++i];
+                } else {
+                    valid = false;
+                }
+            }
+            if (valid) {
+                parametri.forma = *forma;
+                return genereazaArbore(parametri, iesire);
+            }
+        }
+        if (argumente[0] == "--benchmark") {
+            std::vector<std::size_t> dimensiuni{1000, 10000, 100000};
+            std::vector<FormaArbore> forme{FormaArbore::Echilibrat, FormaArbore::Lant, FormaArbore::Aleator};
+            std::size_t jocuri = 10000;
+            std::string iesire;
+            bool valid = true;
+            // Liste separate prin virgula, ex. "1000,100000".
+            auto elemente = [](const std::string& lista) {
+                std::vector<std::string> rezultat;
+                std::istringstream is(lista);
+                for (std::string element; std::getline(is, element, ',');) {
+                    if (!element.empty()) rezultat.push_back(element);
+                }
+                return rezultat;
+            };
+            for (std::size_t i = 1; valid && i < argumente.size(); ++i) {
+                if (i + 1 >= argumente.size()) {
+                    valid = false;
+                } else if (argumente[i] == "--entitati") {
+                    dimensiuni.clear();
+                    for (const std::string& e : elemente(argumente[++i])) dimensiuni.push_back(std::strtoull(e.c_str(), nullptr, 10));
+                    valid = !dimensiuni.empty();
+                } else if (argumente[i] == "--forme") {
+                    forme.clear();
+                    for (const std::string& e : elemente(argumente[++i])) {
+                        const auto forma = formaDinNume(e);
+                        if (!forma) valid = false;
+                        else forme.push_back(*forma);
+                    }
+                    valid = valid && !forme.empty();
+                } else if (argumente[i] == "--jocuri") {
+                    jocuri = std::strtoull(argumente[++i].c_str(), nullptr, 10);
+                } else if (argumente[i] == "--iesire") {
+                    iesire = argumente[++i];
+                } else {
+                    valid = false;
+                }
+            }
+            if (valid) return ruleazaBenchmark(dimensiuni, forme, jocuri, iesire);
+        }
+        if (argumente[0] == "--invata" && argumente.size() == 8) {
+            return invataDinLiniaDeComanda(argumente);
+        }
+        if (argumente[0] == "--checkpoint" && argumente.size() == 2) {
+            return checkpointTema(argumente[1]);
+        }
+        // Optiuni comune modurilor --lot si --server.
+        FormatLot format = FormatLot::Rezultat;
+        std::size_t lucratori = 0;
+        std::string metrici;
+        std::size_t checkpoint = 0;
+        bool optiuni_valide = argumente.size() >= 2;
+        for (std::size_t i = 2; optiuni_valide && i < argumente.size(); ++i) {
+            if (argumente[i] == "--transcriere" && format == FormatLot::Rezultat) {
+                format = FormatLot::Transcriere;
+            } else if (argumente[i] == "--evenimente" && format == FormatLot::Rezultat) {
+                format = FormatLot::Evenimente;
+            } else if (argumente[i] == "--lucratori" && i + 1 < argumente.size()) {
+                lucratori = std::strtoul(argumente[++i].c_str(), nullptr, 10);
+                optiuni_valide = lucratori > 0;
+            } else if (argumente[i] == "--metrici" && i + 1 < argumente.size()) {
+                metrici = argumente[++i];
+            } else if (argumente[i] == "--checkpoint" && i + 1 < argumente.size()) {
+                checkpoint = std::strtoul(argumente[++i].c_str(), nullptr, 10);
+                optiuni_valide = checkpoint > 0;
+            } else {
+                optiuni_valide = false;
+            }
+        }
+        if (argumente[0] == "--lot" && optiuni_valide && checkpoint == 0) {
+            return ruleazaModLot(argumente[1], format, std::max<std::size_t>(lucratori, 1), metrici);
+        }
+        if (argumente[0] == "--server" && optiuni_valide && format == FormatLot::Rezultat) {
+            const unsigned long port = std::strtoul(argumente[1].c_str(), nullptr, 10);
+            if (port <= std::numeric_limits<std::uint16_t>::max()) {
+                const std::size_t implicit = std::max(1U, std::thread::hardware_concurrency());
+                return ruleazaModServer(static_cast<std::uint16_t>(port), lucratori ? lucratori : implicit, metrici, checkpoint);
+            }
+        }
+        std::cerr << "Utilizare: oop [--probabilist]\n"
+                     "           oop [--converteste <fisier.json> [<fisier.akb>]]\n"
+                     "           oop [--analizeaza <fisier.json | fisier.akb>]\n"
+                     "           oop [--lot <sesiuni.txt | -> [--transcriere | --evenimente] [--lucratori N] [--metrici <fisier>]]\n"
+                     "           oop [--randeaza <evenimente.txt | ->]\n"
+                     "           oop [--server <port> [--lucratori N] [--metrici <fisier>] [--checkpoint <secunde>]]\n"
+                     "           oop [--invata <tema> <cale d/n> <nume> <domeniu> <tip> <intrebare> <da|nu>]\n"
+                     "           oop [--checkpoint <tema>]\n"
+                     "           oop [--cauta <tema> <nume>]\n"
+                     "           oop [--simuleaza <tema> [--zgomot p]]\n"
+                     "           oop [--optimizeaza <tema> [--statistici <sesiuni.txt> [--probabilist]] [--iesire <fisier.json>]]\n"
+                     "           oop [--genereaza <echilibrat|lant|aleator> <entitati> [--asimetrie a] [--adancime-maxima D] [--samanta s] [--iesire <fisier.json>]]\n"
+                     "           oop [--benchmark [--entitati 1000,10000,...] [--forme echilibrat,lant,aleator] [--jocuri N] [--iesire <fisier.json>]]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream is(FISIER_INTRARE);
+    std::ofstream os(FISIER_IESIRE);
+
+    if (!is.is_open() || !os.is_open()) {
+        std::cerr << "Eroare critica: Fisierele de I/O (tastatura.txt, raspuns.txt) nu sunt deschise corect." << std::endl;
+        return 1;
+    }
+
+    JocAkinator joc;
+
+    if (probabilist) {
+        joc.ruleazaProbabilist(is, os);
+    } else {
+        joc.ruleazaSilentios(is, os);
+    }
 
     // Verificari Structura & R3
     ManagerRaspunsuri manager_original;
@@ -0,0 +1,165 @@
+#!/usr/bin/bash
+
+# Verificari pentru caile de eroare ale incarcatoarelor: fiecare fisier stricat trebuie
+# respins cu un mesaj si codul de iesire 1 (nu cu un crash sau o eroare de sanitizer).
+
+BUILD_DIR=${BUILD_DIR:-build}
+EXECUTABLE_NAME=${EXECUTABLE_NAME:-oop}
+
+if [[ -n "$1" ]]; then
+    BIN_DIR="$1"
+elif [[ -d "install_dir/bin" ]]; then
+    BIN_DIR="install_dir/bin"
+else
+    BIN_DIR="${BUILD_DIR}"
+fi
+
+OOP="$(cd "${BIN_DIR}" && pwd)/${EXECUTABLE_NAME}"
+SRC_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+TMP_DIR="$(mktemp -d)"
+trap 'rm -rf "${TMP_DIR}"' EXIT
+cd "${TMP_DIR}" || exit 1
+
+failed=0
+
+# expect_ok <descriere> <argumente...>
+expect_ok() {
+    local desc="$1"
+    shift
+    if ! "${OOP}" "$@" > out.txt 2>&1; then
+        echo "FAIL: ${desc}: codul de iesire $?"
+        cat out.txt
+        failed=1
+    else
+        echo "ok: ${desc}"
+    fi
+}
+
+# expect_error <descriere> <fragment din mesaj> <argumente...>
+expect_error() {
+    local desc="$1" mesaj="$2"
+    shift 2
+    "${OOP}" "$@" > out.txt 2>&1
+    local rc=$?
+    if [[ ${rc} -ne 1 ]] || ! grep -qF -- "${mesaj}" out.txt; then
+        echo "FAIL: ${desc}: codul de iesire ${rc}, se astepta 1 si \"${mesaj}\""
+        cat out.txt
+        failed=1
+    else
+        echo "ok: ${desc}"
+    fi
+}
+
+# patch_akb <fisier> <offset> <valoare uint32>: scrie valoarea si recalculeaza suma de control
+patch_akb() {
+    python3 - "$@" <<'EOF'
+import struct, sys
+cale, offset, valoare = sys.argv[1], int(sys.argv[2]), int(sys.argv[3])
+date = bytearray(open(cale, "rb").read())
+struct.pack_into("<I", date, offset, valoare)
+h, continut = 14695981039346656037, bytes(date[32:])
+complet = len(continut) // 8 * 8
+for (cuvant,) in struct.iter_unpack("<Q", continut[:complet]):
+    h = ((h ^ cuvant) * 1099511628211) & 0xFFFFFFFFFFFFFFFF
+for octet in continut[complet:]:
+    h = ((h ^ octet) * 1099511628211) & 0xFFFFFFFFFFFFFFFF
+struct.pack_into("<Q", date, 24, h)
+open(cale, "wb").write(date)
+EOF
+}
+
+# --- .akb ---
+# Antetul are 32 de octeti (radacina la 8), apoi nodurile cate 20 de octeti: text (8), da, nu, entitate.
+cp "${SRC_DIR}/tari_arbore.json" .
+expect_ok "conversie JSON -> .akb" --converteste tari_arbore.json tari.akb
+expect_ok "incarcare .akb valid" --analizeaza tari.akb
+
+head -c 20 tari.akb > antet_trunchiat.akb
+expect_error ".akb mai scurt decat antetul" "trunchiat" --analizeaza antet_trunchiat.akb
+
+head -c -7 tari.akb > trunchiat.akb
+expect_error ".akb trunchiat" "Dimensiune incoerenta" --analizeaza trunchiat.akb
+
+cp tari_arbore.json json.akb
+expect_error "JSON redenumit .akb" "nu este un arbore binar" --analizeaza json.akb
+
+cp tari.akb suma.akb
+printf '\x55' | dd of=suma.akb bs=1 seek=40 conv=notrunc status=none
+expect_error "suma de control gresita" "Suma de control gresita" --analizeaza suma.akb
+
+radacina=$(python3 -c "import struct; print(struct.unpack_from('<I', open('tari.akb', 'rb').read(), 8)[0])")
+cp tari.akb radacina.akb
+patch_akb radacina.akb 8 1000000
+expect_error "radacina in afara arborelui" "Radacina invalida" --analizeaza radacina.akb
+
+cp tari.akb copil.akb
+patch_akb copil.akb $((32 + 20 * radacina + 8)) 1000000
+expect_error "copil in afara arborelui" "copil inexistent" --analizeaza copil.akb
+
+cp tari.akb ciclu.akb
+patch_akb ciclu.akb $((32 + 20 * radacina + 8)) "${radacina}"
+expect_error "radacina drept copil (ciclu)" "radacina apare drept copilul" --analizeaza ciclu.akb
+
+cp tari.akb pool.akb
+patch_akb pool.akb $((32 + 20 * radacina)) 4000000000
+expect_error "text in afara pool-ului" "iese din pool" --analizeaza pool.akb
+
+# --- JSON ---
+head -c -10 tari_arbore.json > trunchiat_arbore.json
+expect_error "JSON trunchiat" "Eroare la parsarea JSON" --analizeaza trunchiat_arbore.json
+
+echo '{"alt": {}}' > fara_radacina_arbore.json
+expect_error "JSON fara radacina" "nu contine" --analizeaza fara_radacina_arbore.json
+
+echo '{"radacina": {"entitate": {"nume": "a", "domeniu": "b", "tip": "c"}, "da": null}}' > mixt_arbore.json
+expect_error "frunza cu copii" "nu poate avea" --analizeaza mixt_arbore.json
+
+echo '{"radacina": {"da": null, "nu": null}}' > gol_arbore.json
+expect_error "nod fara intrebare si entitate" "trebuie sa aiba \"intrebare\"" --analizeaza gol_arbore.json
+
+echo '{"radacina": {"entitate": {"nume": "a", "tip": "c"}}}' > entitate_arbore.json
+expect_error "entitate incompleta" "entitatea trebuie sa aiba" --analizeaza entitate_arbore.json
+
+echo '{"radacina": {"intrebare": 5}}' > numar_arbore.json
+expect_error "intrebare care nu e sir" "se astepta un sir" --analizeaza numar_arbore.json
+
+python3 -c "print('{\"radacina\": {\"intrebare\": \"q\", \"x\": ' + '[' * 1000000)" > adanc_arbore.json
+expect_error "JSON cu un milion de liste deschise" "Eroare la parsarea JSON" --analizeaza adanc_arbore.json
+
+expect_ok "generare lant de 100000 de niveluri" --genereaza lant 100000 --iesire lant_arbore.json
+expect_ok "incarcare lant de 100000 de niveluri" --analizeaza lant_arbore.json
+
+# Benchmark-ul incarca fiecare arbore si prin DOM si verifica ca iese acelasi arbore.
+expect_ok "incarcatorul DOM ca SAX" --benchmark --entitati 100 --jocuri 10 --iesire benchmark.json
+
+# --- evenimente ---
+# Transcrierea refacuta din evenimente trebuie sa fie chiar textul lui --transcriere.
+cp "${SRC_DIR}/tastatura.txt" "${SRC_DIR}/animale_arbore.json" "${SRC_DIR}/vedeta_arbore.json" .
+{ tr '\n\r' '  ' < tastatura.txt; echo; echo 'tari da poate nu'; echo 'tari'; echo 'xyz da'; } > sesiuni.txt
+"${OOP}" --lot sesiuni.txt --transcriere > transcriere.txt 2> /dev/null
+"${OOP}" --lot sesiuni.txt --evenimente 2> /dev/null | "${OOP}" --randeaza - > randat.txt 2> out.txt
+if [[ $? -ne 0 ]] || ! cmp -s transcriere.txt randat.txt; then
+    echo "FAIL: --randeaza nu reface --transcriere"
+    cat out.txt
+    diff transcriere.txt randat.txt | head -20
+    failed=1
+else
+    echo "ok: --randeaza reface --transcriere"
+fi
+printf '1\ttari\tItalia\t0:d:1 4000000000:d:2\n' > evenimente_straine.txt
+expect_error "evenimente pe alt arbore" "nu exista in tema" --randeaza evenimente_straine.txt
+
+# --- invatare ---
+# O propunere respinsa urmata de lectie, in --lot; jocul urmator trebuie sa ajunga la entitatea noua.
+printf '%s\n' 'tari da da da da nu da "Costa Rica" America tara "Este in America Centrala?" da' > invata.txt
+expect_ok "invatare dupa o ghicire gresita" --lot invata.txt
+if ! grep -qF "invatat: Costa Rica" out.txt || ! grep -qF '"Costa Rica"' tari_arbore.jurnal; then
+    echo "FAIL: lectia nu apare in rezultat sau in jurnal"
+    cat out.txt
+    failed=1
+fi
+printf '%s\n' 'tari da da da da da da' > dupa.txt
+expect_ok "jocul dupa invatare" --lot dupa.txt
+grep -qF "Costa Rica" out.txt || { echo "FAIL: jocul nu ajunge la entitatea invatata"; cat out.txt; failed=1; }
+
+exit ${failed}